@@ -0,0 +1,121 @@
+/****************************************************************************************************************************
+  Async_DeferredResponse.ino - Dead simple AsyncWebServer for WT32_ETH01
+
+  For LAN8720 Ethernet in WT32_ETH01 (ESP32 + LAN8720)
+
+  AsyncWebServer_WT32_ETH01 is a library for the Ethernet LAN8720 in WT32_ETH01 to run AsyncWebServer
+
+  Based on and modified from ESPAsyncWebServer (https://github.com/me-no-dev/ESPAsyncWebServer)
+  Built by Khoi Hoang https://github.com/khoih-prog/AsyncWebServer_WT32_ETH01
+  Licensed under GPLv3 license
+ *****************************************************************************************************************************/
+
+// Slow requests (here a simulated 2 s bus read) are answered by a worker task, while the server keeps
+// serving other clients : the handler only defers the request and queues the handle.
+
+#if !( defined(ESP32) )
+	#error This code is designed for WT32_ETH01 to run on ESP32 platform! Please check your Tools->Board setting.
+#endif
+
+#include <Arduino.h>
+
+#define _ASYNC_WEBSERVER_LOGLEVEL_       2
+
+// Select the IP address according to your local network
+IPAddress myIP(192, 168, 2, 232);
+IPAddress myGW(192, 168, 2, 1);
+IPAddress mySN(255, 255, 255, 0);
+
+// Google DNS Server IP
+IPAddress myDNS(8, 8, 8, 8);
+
+#include <AsyncTCP.h>
+
+#include <AsyncWebServer_WT32_ETH01.h>
+
+AsyncWebServer    server(80);
+
+QueueHandle_t     slowRequests;
+
+// Blocking work, off the AsyncTCP task
+uint16_t readRegister()
+{
+	delay(2000);
+
+	return random(0, 1000);
+}
+
+void worker(void * parameter)
+{
+	WT32_ETH01_AWS_UNUSED(parameter);
+
+	AsyncDeferredResponse * deferred;
+
+	for (;;)
+	{
+		if (xQueueReceive(slowRequests, &deferred, portMAX_DELAY) != pdTRUE)
+			continue;
+
+		if (deferred->cancelled())
+		{
+			// Client gone : skip the work, but the handle must still be completed
+			deferred->send(nullptr);
+			continue;
+		}
+
+		deferred->send(200, "text/plain", String("Register = ") + readRegister());
+	}
+}
+
+void setup()
+{
+	Serial.begin(115200);
+
+	while (!Serial && millis() < 5000);
+
+	delay(200);
+
+	Serial.print(F("\nStart Async_DeferredResponse on "));
+	Serial.print(BOARD_NAME);
+	Serial.print(F(" with "));
+	Serial.println(SHIELD_TYPE);
+	Serial.println(ASYNC_WEBSERVER_WT32_ETH01_VERSION);
+
+	// To be called before ETH.begin()
+	WT32_ETH01_onEvent();
+
+	ETH.begin(ETH_PHY_ADDR, ETH_PHY_POWER);
+
+	// Static IP, leave without this line to get IP via DHCP
+	ETH.config(myIP, myGW, mySN, myDNS);
+
+	WT32_ETH01_waitForConnect();
+
+	slowRequests = xQueueCreate(8, sizeof(AsyncDeferredResponse *));
+	xTaskCreate(worker, "worker", 4096, nullptr, 1, nullptr);
+
+	server.on("/register", HTTP_GET, [](AsyncWebServerRequest * request)
+	{
+		AsyncDeferredResponse * deferred = request->defer();
+
+		if (xQueueSend(slowRequests, &deferred, 0) != pdTRUE)
+		{
+			// Queue full : answer through the handle, the request itself is detached
+			deferred->send(503, "text/plain", "Busy");
+		}
+	});
+
+	server.on("/", HTTP_GET, [](AsyncWebServerRequest * request)
+	{
+		request->send(200, "text/plain", "Still responsive, try /register");
+	});
+
+	server.begin();
+
+	Serial.print(F("HTTP EthernetWebServer is @ IP : "));
+	Serial.println(ETH.localIP());
+}
+
+void loop()
+{
+}
@@ -0,0 +1,82 @@
+/****************************************************************************************************************************
+  Async_EmbeddedAssets.ino - Dead simple AsyncWebServer for WT32_ETH01
+
+  For LAN8720 Ethernet in WT32_ETH01 (ESP32 + LAN8720)
+
+  AsyncWebServer_WT32_ETH01 is a library for the Ethernet LAN8720 in WT32_ETH01 to run AsyncWebServer
+
+  Based on and modified from ESPAsyncWebServer (https://github.com/me-no-dev/ESPAsyncWebServer)
+  Built by Khoi Hoang https://github.com/khoih-prog/AsyncWebServer_WT32_ETH01
+  Licensed under GPLv3 license
+ *****************************************************************************************************************************/
+
+// Serves the files of data/ from flash, without any filesystem.
+// embedded_assets.h is generated from data/ with, from the library directory :
+//   python3 utils/embed_assets.py examples/Async_EmbeddedAssets/data examples/Async_EmbeddedAssets/embedded_assets.h --cache-control "max-age=86400"
+
+#if !( defined(ESP32) )
+	#error This code is designed for WT32_ETH01 to run on ESP32 platform! Please check your Tools->Board setting.
+#endif
+
+#include <Arduino.h>
+
+#define _ASYNC_WEBSERVER_LOGLEVEL_       2
+
+// Select the IP address according to your local network
+IPAddress myIP(192, 168, 2, 232);
+IPAddress myGW(192, 168, 2, 1);
+IPAddress mySN(255, 255, 255, 0);
+
+// Google DNS Server IP
+IPAddress myDNS(8, 8, 8, 8);
+
+#include <AsyncTCP.h>
+
+#include <AsyncWebServer_WT32_ETH01.h>
+#include <AsyncEmbeddedAssets.h>
+
+#include "embedded_assets.h"
+
+AsyncWebServer    server(80);
+
+void setup()
+{
+	Serial.begin(115200);
+
+	while (!Serial && millis() < 5000);
+
+	delay(200);
+
+	Serial.print(F("\nStart Async_EmbeddedAssets on "));
+	Serial.print(BOARD_NAME);
+	Serial.print(F(" with "));
+	Serial.println(SHIELD_TYPE);
+	Serial.println(ASYNC_WEBSERVER_WT32_ETH01_VERSION);
+
+	// To be called before ETH.begin()
+	WT32_ETH01_onEvent();
+
+	ETH.begin(ETH_PHY_ADDR, ETH_PHY_POWER);
+
+	// Static IP, leave without this line to get IP via DHCP
+	ETH.config(myIP, myGW, mySN, myDNS);
+
+	WT32_ETH01_waitForConnect();
+
+	// "/" is index.html, "/style.css" the stylesheet
+	server.addHandler(new AsyncEmbeddedWebHandler(embeddedAssets));
+
+	server.onNotFound([](AsyncWebServerRequest * request)
+	{
+		request->send(404, "text/plain", "Not found");
+	});
+
+	server.begin();
+
+	Serial.print(F("HTTP EthernetWebServer is @ IP : "));
+	Serial.println(ETH.localIP());
+}
+
+void loop()
+{
+}
@@ -0,0 +1,92 @@
+// Generated by utils/embed_assets.py from data, do not edit
+
+#ifndef EMBEDDED_ASSETS_H_
+#define EMBEDDED_ASSETS_H_
+
+#include "AsyncEmbeddedAssets.h"
+
+// /index.html
+static const uint8_t embeddedAssets_head_0[] PROGMEM =
+{
+  0x43, 0x61, 0x63, 0x68, 0x65, 0x2D, 0x43, 0x6F, 0x6E, 0x74, 0x72, 0x6F, 0x6C, 0x3A, 0x20, 0x6D,
+  0x61, 0x78, 0x2D, 0x61, 0x67, 0x65, 0x3D, 0x38, 0x36, 0x34, 0x30, 0x30, 0x0D, 0x0A, 0x56, 0x61,
+  0x72, 0x79, 0x3A, 0x20, 0x41, 0x63, 0x63, 0x65, 0x70, 0x74, 0x2D, 0x45, 0x6E, 0x63, 0x6F, 0x64,
+  0x69, 0x6E, 0x67, 0x0D, 0x0A, 0x45, 0x54, 0x61, 0x67, 0x3A, 0x20, 0x22, 0x31, 0x33, 0x36, 0x32,
+  0x38, 0x32, 0x61, 0x38, 0x38, 0x36, 0x37, 0x63, 0x66, 0x35, 0x63, 0x35, 0x22, 0x0D, 0x0A, 0x43,
+  0x6F, 0x6E, 0x6E, 0x65, 0x63, 0x74, 0x69, 0x6F, 0x6E, 0x3A, 0x20, 0x63, 0x6C, 0x6F, 0x73, 0x65,
+  0x0D, 0x0A, 0x43, 0x6F, 0x6E, 0x74, 0x65, 0x6E, 0x74, 0x2D, 0x4C, 0x65, 0x6E, 0x67, 0x74, 0x68,
+  0x3A, 0x20, 0x32, 0x32, 0x32, 0x0D, 0x0A, 0x43, 0x6F, 0x6E, 0x74, 0x65, 0x6E, 0x74, 0x2D, 0x54,
+  0x79, 0x70, 0x65, 0x3A, 0x20, 0x74, 0x65, 0x78, 0x74, 0x2F, 0x68, 0x74, 0x6D, 0x6C, 0x0D, 0x0A,
+  0x43, 0x6F, 0x6E, 0x74, 0x65, 0x6E, 0x74, 0x2D, 0x45, 0x6E, 0x63, 0x6F, 0x64, 0x69, 0x6E, 0x67,
+  0x3A, 0x20, 0x67, 0x7A, 0x69, 0x70, 0x0D, 0x0A, 0x41, 0x63, 0x63, 0x65, 0x70, 0x74, 0x2D, 0x52,
+  0x61, 0x6E, 0x67, 0x65, 0x73, 0x3A, 0x20, 0x6E, 0x6F, 0x6E, 0x65, 0x0D, 0x0A,
+};
+
+static const uint8_t embeddedAssets_content_0[] PROGMEM =
+{
+  0x1F, 0x8B, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x4D, 0x90, 0xC1, 0x4E, 0xC3, 0x30,
+  0x10, 0x44, 0xEF, 0xFD, 0x8A, 0x21, 0x77, 0x12, 0x52, 0x2E, 0x1C, 0x5C, 0x5F, 0xA0, 0x12, 0x37,
+  0x2A, 0x35, 0x12, 0xE2, 0x54, 0x39, 0xF5, 0xA6, 0xB6, 0xB0, 0xDB, 0xC8, 0xBB, 0x29, 0xCA, 0xDF,
+  0xE3, 0x3A, 0x20, 0x38, 0xAD, 0xB4, 0x33, 0x3B, 0xF3, 0xB4, 0xEA, 0xEE, 0xE5, 0xED, 0xB9, 0xFB,
+  0xD8, 0x6D, 0xE1, 0x24, 0x06, 0xBD, 0x52, 0xBF, 0x83, 0x8C, 0xD5, 0x2B, 0x40, 0x45, 0x12, 0x83,
+  0xA3, 0x33, 0x89, 0x49, 0x36, 0xD5, 0x24, 0xC3, 0xFD, 0x53, 0x55, 0x04, 0xF1, 0x12, 0x48, 0xBF,
+  0x77, 0x8F, 0xEB, 0xC3, 0xB6, 0x7B, 0x7D, 0x68, 0x41, 0xB1, 0x27, 0x6B, 0xC9, 0xC2, 0x70, 0xF6,
+  0xB2, 0x6A, 0x16, 0xC7, 0xCD, 0x1B, 0xFC, 0xF9, 0x13, 0x89, 0xC2, 0xA6, 0x62, 0x99, 0x03, 0xB1,
+  0x23, 0x92, 0x0A, 0x2E, 0xD1, 0xF0, 0xB3, 0xA9, 0x8F, 0xCC, 0x39, 0x56, 0x35, 0x4B, 0xAF, 0xEA,
+  0x2F, 0x76, 0x2E, 0x97, 0xAE, 0xD5, 0x7B, 0x4A, 0xD7, 0x9C, 0x3A, 0xA4, 0x4B, 0xC4, 0x10, 0x0C,
+  0xBB, 0xEC, 0x6A, 0x8B, 0x38, 0xEA, 0xCE, 0x79, 0xC6, 0x68, 0x4E, 0x04, 0x73, 0xB6, 0xF0, 0xC2,
+  0xF8, 0x2B, 0xC0, 0x17, 0x25, 0xFA, 0x47, 0x25, 0xE8, 0x27, 0x1F, 0x2C, 0xC4, 0x47, 0x42, 0x3F,
+  0x63, 0x12, 0x1F, 0xB8, 0x29, 0xFA, 0x61, 0x41, 0xAE, 0xC7, 0xB9, 0x56, 0xCD, 0x78, 0xE3, 0x58,
+  0x00, 0x72, 0x53, 0x79, 0xC7, 0x37, 0x68, 0xB2, 0x5C, 0x07, 0x26, 0x01, 0x00, 0x00,
+};
+
+// /style.css
+static const uint8_t embeddedAssets_head_1[] PROGMEM =
+{
+  0x43, 0x61, 0x63, 0x68, 0x65, 0x2D, 0x43, 0x6F, 0x6E, 0x74, 0x72, 0x6F, 0x6C, 0x3A, 0x20, 0x6D,
+  0x61, 0x78, 0x2D, 0x61, 0x67, 0x65, 0x3D, 0x38, 0x36, 0x34, 0x30, 0x30, 0x0D, 0x0A, 0x45, 0x54,
+  0x61, 0x67, 0x3A, 0x20, 0x22, 0x33, 0x31, 0x34, 0x37, 0x37, 0x35, 0x65, 0x63, 0x37, 0x66, 0x35,
+  0x64, 0x31, 0x66, 0x63, 0x39, 0x22, 0x0D, 0x0A, 0x43, 0x6F, 0x6E, 0x6E, 0x65, 0x63, 0x74, 0x69,
+  0x6F, 0x6E, 0x3A, 0x20, 0x63, 0x6C, 0x6F, 0x73, 0x65, 0x0D, 0x0A, 0x43, 0x6F, 0x6E, 0x74, 0x65,
+  0x6E, 0x74, 0x2D, 0x4C, 0x65, 0x6E, 0x67, 0x74, 0x68, 0x3A, 0x20, 0x31, 0x34, 0x32, 0x0D, 0x0A,
+  0x43, 0x6F, 0x6E, 0x74, 0x65, 0x6E, 0x74, 0x2D, 0x54, 0x79, 0x70, 0x65, 0x3A, 0x20, 0x74, 0x65,
+  0x78, 0x74, 0x2F, 0x63, 0x73, 0x73, 0x0D, 0x0A, 0x41, 0x63, 0x63, 0x65, 0x70, 0x74, 0x2D, 0x52,
+  0x61, 0x6E, 0x67, 0x65, 0x73, 0x3A, 0x20, 0x6E, 0x6F, 0x6E, 0x65, 0x0D, 0x0A,
+};
+
+static const uint8_t embeddedAssets_content_1[] PROGMEM =
+{
+  0x62, 0x6F, 0x64, 0x79, 0x0A, 0x7B, 0x0A, 0x20, 0x20, 0x66, 0x6F, 0x6E, 0x74, 0x2D, 0x66, 0x61,
+  0x6D, 0x69, 0x6C, 0x79, 0x3A, 0x20, 0x41, 0x72, 0x69, 0x61, 0x6C, 0x2C, 0x20, 0x48, 0x65, 0x6C,
+  0x76, 0x65, 0x74, 0x69, 0x63, 0x61, 0x2C, 0x20, 0x73, 0x61, 0x6E, 0x73, 0x2D, 0x73, 0x65, 0x72,
+  0x69, 0x66, 0x3B, 0x0A, 0x20, 0x20, 0x62, 0x61, 0x63, 0x6B, 0x67, 0x72, 0x6F, 0x75, 0x6E, 0x64,
+  0x2D, 0x63, 0x6F, 0x6C, 0x6F, 0x72, 0x3A, 0x20, 0x23, 0x66, 0x34, 0x66, 0x34, 0x66, 0x34, 0x3B,
+  0x0A, 0x20, 0x20, 0x63, 0x6F, 0x6C, 0x6F, 0x72, 0x3A, 0x20, 0x23, 0x33, 0x33, 0x33, 0x33, 0x33,
+  0x33, 0x3B, 0x0A, 0x20, 0x20, 0x6D, 0x61, 0x72, 0x67, 0x69, 0x6E, 0x3A, 0x20, 0x32, 0x65, 0x6D,
+  0x3B, 0x0A, 0x7D, 0x0A, 0x0A, 0x68, 0x31, 0x0A, 0x7B, 0x0A, 0x20, 0x20, 0x63, 0x6F, 0x6C, 0x6F,
+  0x72, 0x3A, 0x20, 0x23, 0x30, 0x30, 0x36, 0x36, 0x63, 0x63, 0x3B, 0x0A, 0x7D, 0x0A,
+};
+
+static const eth::AwsEmbeddedAsset embeddedAssets_assets[] =
+{
+  { "/index.html", embeddedAssets_head_0, 189, 98, embeddedAssets_content_0, 222, "\"136282a8867cf5c5\"", true },
+  { "/style.css", embeddedAssets_head_1, 141, 75, embeddedAssets_content_1, 142, "\"314775ec7f5d1fc9\"", false },
+  { "/", embeddedAssets_head_0, 189, 98, embeddedAssets_content_0, 222, "\"136282a8867cf5c5\"", true },
+};
+
+static const int32_t embeddedAssets_displacements[] =
+{
+  -3, -2, -1
+};
+
+static const uint16_t embeddedAssets_slots[] =
+{
+  1, 2, 0
+};
+
+static const eth::AwsEmbeddedBundle embeddedAssets =
+{
+  embeddedAssets_assets, embeddedAssets_displacements, embeddedAssets_slots, 3
+};
+
+#endif    // EMBEDDED_ASSETS_H_
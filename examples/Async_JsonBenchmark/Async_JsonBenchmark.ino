@@ -0,0 +1,225 @@
+/****************************************************************************************************************************
+  Async_JsonBenchmark.ino
+
+  For LAN8720 Ethernet in WT32_ETH01 (ESP32 + LAN8720)
+
+  AsyncWebServer_WT32_ETH01 is a library for the Ethernet LAN8720 in WT32_ETH01 to run AsyncWebServer
+
+  Based on and modified from ESPAsyncWebServer (https://github.com/me-no-dev/ESPAsyncWebServer)
+  Built by Khoi Hoang https://github.com/khoih-prog/AsyncWebServer_WT32_ETH01
+  Licensed under GPLv3 license
+ *****************************************************************************************************************************/
+
+// Benchmark of AsyncJsonResponse with a document of about 40 KB.
+// At startup, the CPU time to produce the whole body is measured, one TCP segment at a time, for :
+//   - the former way : the document serialised again from the start for each segment, skipping what was sent (ChunkPrint)
+//   - AsyncJsonResponse : the document serialised once into pooled segments
+// Both are also served, compare e.g. : time curl -s -o /dev/null http://192.168.2.232/json
+//                                      time curl -s -o /dev/null http://192.168.2.232/json-chunkprint
+
+#if !( defined(ESP32) )
+  #error This code is designed for WT32_ETH01 to run on ESP32 platform! Please check your Tools->Board setting.
+#endif
+
+#include <Arduino.h>
+
+#define _ASYNC_WEBSERVER_LOGLEVEL_       2
+
+// Select the IP address according to your local network
+IPAddress myIP(192, 168, 2, 232);
+IPAddress myGW(192, 168, 2, 1);
+IPAddress mySN(255, 255, 255, 0);
+
+// Google DNS Server IP
+IPAddress myDNS(8, 8, 8, 8);
+
+#include <AsyncTCP.h>
+
+#include <AsyncWebServer_WT32_ETH01.h>
+#include <AsyncJson.h>
+#include <ArduinoJson.h>
+
+AsyncWebServer server(80);
+
+// About 65 bytes of JSON per record
+#define NUMBER_OF_RECORDS     600
+#define JSON_CAPACITY         (JSON_ARRAY_SIZE(NUMBER_OF_RECORDS) + NUMBER_OF_RECORDS * JSON_OBJECT_SIZE(5) + 1024)
+
+// Typical TCP MSS, the size asked to _fillBuffer() for each segment
+#define SEGMENT_SIZE          1436
+
+const char* const sensorNames[] = { "temperature", "humidity", "pressure", "voltage" };
+
+// The former AsyncJsonResponse::_fillBuffer(), kept for comparison
+class ChunkPrintJsonResponse: public AsyncJsonResponse
+{
+  public:
+    ChunkPrintJsonResponse() : AsyncJsonResponse(true, JSON_CAPACITY) {}
+
+    size_t _fillBuffer(uint8_t *data, size_t len)
+    {
+      ChunkPrint dest(data, _sentLength, len);
+
+      serializeJson(_root, dest);
+
+      return len;
+    }
+};
+
+void fillDocument(JsonVariant root)
+{
+  JsonArray records = root.as<JsonArray>();
+
+  for (uint16_t i = 0; i < NUMBER_OF_RECORDS; i++)
+  {
+    JsonObject record = records.createNestedObject();
+
+    record["id"]      = i;
+    record["sensor"]  = sensorNames[i % 4];
+    record["value"]   = 20.0 + (i % 100) / 10.0;
+    record["time"]    = 1700000000UL + i;
+    record["ok"]      = (i % 7) != 0;
+  }
+}
+
+// CPU time to produce the whole body, SEGMENT_SIZE bytes at a time
+void benchmark()
+{
+  static uint8_t segment[SEGMENT_SIZE];
+
+  AsyncJsonResponse* response = new AsyncJsonResponse(true, JSON_CAPACITY);
+
+  fillDocument(response->getRoot());
+
+  const size_t length = response->setLength();
+
+  // Former way : serialise from the start for each segment, skipping the bytes already sent
+  uint32_t start = micros();
+
+  for (size_t sent = 0; sent < length; sent += SEGMENT_SIZE)
+  {
+    ChunkPrint dest(segment, sent, SEGMENT_SIZE);
+
+    serializeJson(response->getRoot(), dest);
+  }
+
+  uint32_t chunkPrintMicros = micros() - start;
+
+  // AsyncJsonResponse : serialised once, then read from the pooled segments
+  uint32_t freeHeap = ESP.getFreeHeap();
+  uint32_t minHeap  = freeHeap;
+  size_t   read     = 0;
+
+  start = micros();
+
+  while (read < length)
+  {
+    size_t len = response->_fillBuffer(segment, SEGMENT_SIZE);
+
+    if (!len)
+      break;
+
+    read += len;
+
+    if (ESP.getFreeHeap() < minHeap)
+      minHeap = ESP.getFreeHeap();
+  }
+
+  uint32_t bufferedMicros = micros() - start;
+
+  delete response;
+
+  Serial.print(F("JSON document : "));
+  Serial.print(length);
+  Serial.print(F(" bytes, "));
+  Serial.print((length + SEGMENT_SIZE - 1) / SEGMENT_SIZE);
+  Serial.println(F(" segments"));
+
+  Serial.print(F("ChunkPrint, serialised per segment : "));
+  Serial.print(chunkPrintMicros);
+  Serial.println(F(" us"));
+
+  Serial.print(F("Serialised once, pooled segments   : "));
+  Serial.print(bufferedMicros);
+  Serial.print(F(" us, "));
+  Serial.print(read);
+  Serial.print(F(" bytes, peak heap used = "));
+  Serial.println(freeHeap - minHeap);
+}
+
+void sendJson(AsyncWebServerRequest *request, AsyncJsonResponse* response)
+{
+  uint32_t startMicros = micros();
+
+  fillDocument(response->getRoot());
+  response->setLength();
+
+  request->onDisconnect([startMicros]()
+  {
+    Serial.print(F("JSON response in "));
+    Serial.print(micros() - startMicros);
+    Serial.print(F(" us, free heap = "));
+    Serial.println(ESP.getFreeHeap());
+  });
+
+  request->send(response);
+}
+
+void setup()
+{
+  Serial.begin(115200);
+
+  while (!Serial && millis() < 5000);
+
+  delay(200);
+
+  Serial.print("\nStart Async_JsonBenchmark on ");
+  Serial.print(BOARD_NAME);
+  Serial.print(" with ");
+  Serial.println(SHIELD_TYPE);
+  Serial.println(ASYNC_WEBSERVER_WT32_ETH01_VERSION);
+
+  benchmark();
+
+  ///////////////////////////////////
+
+  // To be called before ETH.begin()
+  WT32_ETH01_onEvent();
+
+  //bool begin(uint8_t phy_addr=ETH_PHY_ADDR, int power=ETH_PHY_POWER, int mdc=ETH_PHY_MDC, int mdio=ETH_PHY_MDIO,
+  //           eth_phy_type_t type=ETH_PHY_TYPE, eth_clock_mode_t clk_mode=ETH_CLK_MODE);
+  //ETH.begin(ETH_PHY_ADDR, ETH_PHY_POWER, ETH_PHY_MDC, ETH_PHY_MDIO, ETH_PHY_TYPE, ETH_CLK_MODE);
+  ETH.begin(ETH_PHY_ADDR, ETH_PHY_POWER);
+
+  // Static IP, leave without this line to get IP via DHCP
+  //bool config(IPAddress local_ip, IPAddress gateway, IPAddress subnet, IPAddress dns1 = 0, IPAddress dns2 = 0);
+  ETH.config(myIP, myGW, mySN, myDNS);
+
+  WT32_ETH01_waitForConnect();
+
+  ///////////////////////////////////
+
+  server.on("/json", HTTP_GET, [](AsyncWebServerRequest * request)
+  {
+    sendJson(request, new AsyncJsonResponse(true, JSON_CAPACITY));
+  });
+
+  server.on("/json-chunkprint", HTTP_GET, [](AsyncWebServerRequest * request)
+  {
+    sendJson(request, new ChunkPrintJsonResponse());
+  });
+
+  server.onNotFound([](AsyncWebServerRequest * request)
+  {
+    request->send(404, "text/plain", "Not found");
+  });
+
+  server.begin();
+
+  Serial.print(F("AsyncWebServer is @ IP : "));
+  Serial.println(ETH.localIP());
+}
+
+void loop()
+{
+}
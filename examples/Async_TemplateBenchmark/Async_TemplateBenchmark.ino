@@ -0,0 +1,157 @@
+/****************************************************************************************************************************
+  Async_TemplateBenchmark.ino
+
+  For LAN8720 Ethernet in WT32_ETH01 (ESP32 + LAN8720)
+
+  AsyncWebServer_WT32_ETH01 is a library for the Ethernet LAN8720 in WT32_ETH01 to run AsyncWebServer
+
+  Based on and modified from ESPAsyncWebServer (https://github.com/me-no-dev/ESPAsyncWebServer)
+  Built by Khoi Hoang https://github.com/khoih-prog/AsyncWebServer_WT32_ETH01
+  Licensed under GPLv3 license
+ *****************************************************************************************************************************/
+
+// Benchmark of the template processor with large (1-4 KB) substituted values.
+// Fetch the page repeatedly, e.g. : for i in $(seq 20); do curl -s -o /dev/null http://192.168.2.232/template; done
+// and watch the timing reported on Serial for each response.
+
+#if !( defined(ESP32) )
+  #error This code is designed for WT32_ETH01 to run on ESP32 platform! Please check your Tools->Board setting.
+#endif
+
+#include <Arduino.h>
+
+#define _ASYNC_WEBSERVER_LOGLEVEL_       2
+
+// Select the IP address according to your local network
+IPAddress myIP(192, 168, 2, 232);
+IPAddress myGW(192, 168, 2, 1);
+IPAddress mySN(255, 255, 255, 0);
+
+// Google DNS Server IP
+IPAddress myDNS(8, 8, 8, 8);
+
+#include <AsyncTCP.h>
+
+#include <AsyncWebServer_WT32_ETH01.h>
+
+AsyncWebServer server(80);
+
+// Number of placeholders in the page, each substituted by a value of 1, 2, 3 or 4 KB
+#define NUMBER_OF_VALUES      16
+
+const char templatePage[] PROGMEM = R"rawliteral(<html><head><title>Template Benchmark</title></head><body>
+<p>%V0%</p><p>%V1%</p><p>%V2%</p><p>%V3%</p><p>%V4%</p><p>%V5%</p><p>%V6%</p><p>%V7%</p>
+<p>%V8%</p><p>%V9%</p><p>%V10%</p><p>%V11%</p><p>%V12%</p><p>%V13%</p><p>%V14%</p><p>%V15%</p>
+<p>100%% done</p></body></html>)rawliteral";
+
+String values[NUMBER_OF_VALUES];
+
+uint32_t startMicros;
+uint32_t processorMicros;
+size_t   substitutedBytes;
+
+String processor(const String& var)
+{
+  uint32_t start = micros();
+
+  String result;
+
+  if (var.startsWith("V"))
+  {
+    int index = var.substring(1).toInt();
+
+    if (index >= 0 && index < NUMBER_OF_VALUES)
+      result = values[index];
+  }
+
+  substitutedBytes += result.length();
+  processorMicros += micros() - start;
+
+  return result;
+}
+
+void handleTemplate(AsyncWebServerRequest *request)
+{
+  startMicros       = micros();
+  processorMicros   = 0;
+  substitutedBytes  = 0;
+
+  request->onDisconnect([]()
+  {
+    uint32_t elapsed = micros() - startMicros;
+
+    Serial.print(F("Template response : "));
+    Serial.print(strlen_P(templatePage) + substitutedBytes);
+    Serial.print(F(" bytes in "));
+    Serial.print(elapsed);
+    Serial.print(F(" us, processor "));
+    Serial.print(processorMicros);
+    Serial.print(F(" us, free heap = "));
+    Serial.println(ESP.getFreeHeap());
+  });
+
+  request->send_P(200, "text/html", templatePage, processor);
+}
+
+void setup()
+{
+  Serial.begin(115200);
+
+  while (!Serial && millis() < 5000);
+
+  delay(200);
+
+  Serial.print("\nStart Async_TemplateBenchmark on ");
+  Serial.print(BOARD_NAME);
+  Serial.print(" with ");
+  Serial.println(SHIELD_TYPE);
+  Serial.println(ASYNC_WEBSERVER_WT32_ETH01_VERSION);
+
+  // Values of 1, 2, 3 and 4 KB, so that substitutions overflow the send buffer into the lookahead cache
+  for (uint16_t i = 0; i < NUMBER_OF_VALUES; i++)
+  {
+    size_t len = 1024 * (1 + (i % 4));
+
+    values[i].reserve(len);
+
+    for (size_t j = 0; j < len; j++)
+      values[i] += (char) ('A' + ((i + j) % 26));
+  }
+
+  ///////////////////////////////////
+
+  // To be called before ETH.begin()
+  WT32_ETH01_onEvent();
+
+  //bool begin(uint8_t phy_addr=ETH_PHY_ADDR, int power=ETH_PHY_POWER, int mdc=ETH_PHY_MDC, int mdio=ETH_PHY_MDIO,
+  //           eth_phy_type_t type=ETH_PHY_TYPE, eth_clock_mode_t clk_mode=ETH_CLK_MODE);
+  //ETH.begin(ETH_PHY_ADDR, ETH_PHY_POWER, ETH_PHY_MDC, ETH_PHY_MDIO, ETH_PHY_TYPE, ETH_CLK_MODE);
+  ETH.begin(ETH_PHY_ADDR, ETH_PHY_POWER);
+
+  // Static IP, leave without this line to get IP via DHCP
+  //bool config(IPAddress local_ip, IPAddress gateway, IPAddress subnet, IPAddress dns1 = 0, IPAddress dns2 = 0);
+  ETH.config(myIP, myGW, mySN, myDNS);
+
+  WT32_ETH01_waitForConnect();
+
+  ///////////////////////////////////
+
+  server.on("/template", HTTP_GET, [](AsyncWebServerRequest * request)
+  {
+    handleTemplate(request);
+  });
+
+  server.onNotFound([](AsyncWebServerRequest * request)
+  {
+    request->send(404, "text/plain", "Not found");
+  });
+
+  server.begin();
+
+  Serial.print(F("AsyncWebServer is @ IP : "));
+  Serial.println(ETH.localIP());
+}
+
+void loop()
+{
+}
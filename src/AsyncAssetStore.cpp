@@ -0,0 +1,336 @@
+/****************************************************************************************************************************
+  AsyncAssetStore.cpp - Dead simple Ethernet AsyncWebServer.
+
+  For LAN8720 Ethernet in WT32_ETH01 (ESP32 + LAN8720)
+
+  AsyncWebServer_WT32_ETH01 is a library for the Ethernet LAN8720 in WT32_ETH01 to run AsyncWebServer
+
+  Based on and modified from ESPAsyncWebServer (https://github.com/me-no-dev/ESPAsyncWebServer)
+  Built by Khoi Hoang https://github.com/khoih-prog/AsyncWebServer_WT32_ETH01
+  Licensed under GPLv3 license
+
+  Original author: Hristo Gochkov
+
+  Copyright (c) 2016 Hristo Gochkov. All rights reserved.
+
+  This library is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License along with this library;
+  if not, write to the Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+  Version: 1.6.2
+
+  Version Modified By   Date      Comments
+  ------- -----------  ---------- -----------
+  1.2.3   K Hoang      17/07/2021 Initial porting for WT32_ETH01 (ESP32 + LAN8720). Sync with ESPAsyncWebServer v1.2.3
+  1.2.4   K Hoang      02/08/2021 Fix Mbed TLS compile error with ESP32 core v2.0.0-rc1+
+  1.2.5   K Hoang      09/10/2021 Update `platform.ini` and `library.json`Working only with core v1.0.6-
+  1.3.0   K Hoang      23/10/2021 Making compatible with breaking core v2.0.0+
+  1.4.0   K Hoang      27/11/2021 Auto detect ESP32 core version
+  1.4.1   K Hoang      29/11/2021 Fix bug in examples to reduce connection time
+  1.5.0   K Hoang      01/10/2022 Fix AsyncWebSocket bug
+  1.6.0   K Hoang      04/10/2022 Option to use cString instead of String to save Heap
+  1.6.1   K Hoang      05/10/2022 Don't need memmove(), String no longer destroyed
+  1.6.2   K Hoang      10/11/2022 Add examples to demo how to use beginChunkedResponse() to send in chunks
+ *****************************************************************************************************************************/
+
+#include "AsyncAssetStore.h"
+
+#include <stdlib.h>
+
+#if defined(ESP32)
+  #include "Arduino.h"
+  #include "AsyncWebServer_WT32_ETH01_Debug.h"
+
+  #include "esp_partition.h"
+
+  #if __has_include("spi_flash_mmap.h")
+    #include "spi_flash_mmap.h"
+  #else
+    #include "esp_spi_flash.h"
+  #endif
+#else
+  #include <fcntl.h>
+  #include <unistd.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+
+  // Host build, for benchmarks : no logging
+  #define AWS_LOGERROR(x)
+  #define AWS_LOGERROR1(x,y)
+#endif
+
+namespace eth {
+
+/////////////////////////////////////////////////
+
+#define ASSET_HEADER_SIZE       16
+#define ASSET_RECORD_SIZE       32
+
+/////////////////////////////////////////////////
+
+static inline uint32_t readU32(const uint8_t* data)
+{
+  uint32_t value;
+
+  memcpy(&value, data, sizeof(value));
+
+  return value;
+}
+
+/////////////////////////////////////////////////
+
+// NUL terminated string fully inside the image
+static bool validString(const uint8_t* image, size_t size, uint32_t offset)
+{
+  return (offset < size) && memchr(image + offset, 0, size - offset);
+}
+
+/////////////////////////////////////////////////
+
+static inline bool validBlob(size_t size, uint32_t offset, uint32_t length)
+{
+  return (offset <= size) && (length <= size - offset);
+}
+
+/////////////////////////////////////////////////
+
+AsyncAssetStore::AsyncAssetStore()
+  : _image(nullptr)
+  , _imageSize(0)
+  , _map(nullptr)
+  , _assets(nullptr)
+  , _bundle{nullptr, nullptr, nullptr, 0}
+{
+}
+
+/////////////////////////////////////////////////
+
+AsyncAssetStore::~AsyncAssetStore()
+{
+  end();
+}
+
+/////////////////////////////////////////////////
+
+// Checks every offset once, so that serving never has to
+bool AsyncAssetStore::_load(const uint8_t* image, size_t size)
+{
+  const uint32_t count = readU32(image + 8);
+
+  if (!count || count > 0xFFFF)
+  {
+    AWS_LOGERROR1("AsyncAssetStore: bad asset count", count);
+
+    return false;
+  }
+
+  const size_t slotsOffset = ASSET_HEADER_SIZE + 4 * count;
+  const size_t recordsOffset = slotsOffset + ((2 * count + 3) & ~3);
+
+  if (recordsOffset + ASSET_RECORD_SIZE * count > size)
+  {
+    AWS_LOGERROR("AsyncAssetStore: truncated index");
+
+    return false;
+  }
+
+  const int32_t* displacements = (const int32_t*) (image + ASSET_HEADER_SIZE);
+  const uint16_t* slots = (const uint16_t*) (image + slotsOffset);
+
+  for (uint32_t i = 0; i < count; i++)
+  {
+    if ( (slots[i] >= count) || ((displacements[i] < 0) && ((uint32_t) (-(int64_t) displacements[i] - 1) >= count)) )
+    {
+      AWS_LOGERROR("AsyncAssetStore: bad hash table");
+
+      return false;
+    }
+  }
+
+  _assets = (AwsEmbeddedAsset*) malloc(count * sizeof(AwsEmbeddedAsset));
+
+  if (!_assets)
+  {
+    AWS_LOGERROR("AsyncAssetStore: out of memory");
+
+    return false;
+  }
+
+  for (uint32_t i = 0; i < count; i++)
+  {
+    const uint8_t* record = image + recordsOffset + ASSET_RECORD_SIZE * i;
+    const uint32_t url = readU32(record);
+    const uint32_t head = readU32(record + 4);
+    const uint32_t headLength = readU32(record + 8);
+    const uint32_t content = readU32(record + 12);
+    const uint32_t contentLength = readU32(record + 16);
+    const uint32_t etag = readU32(record + 20);
+    const uint32_t notModifiedLength = readU32(record + 24);
+    const uint32_t gzip = readU32(record + 28);
+
+    if (!validString(image, size, url) || !validString(image, size, etag) || !validBlob(size, head, headLength)
+        || !validBlob(size, content, contentLength) || (notModifiedLength > headLength) || (gzip > 1))
+    {
+      AWS_LOGERROR1("AsyncAssetStore: bad record", i);
+
+      free(_assets);
+      _assets = nullptr;
+
+      return false;
+    }
+
+    _assets[i].url = (const char*) (image + url);
+    _assets[i].head = image + head;
+    _assets[i].headLength = headLength;
+    _assets[i].notModifiedLength = notModifiedLength;
+    _assets[i].content = image + content;
+    _assets[i].contentLength = contentLength;
+    _assets[i].etag = (const char*) (image + etag);
+    _assets[i].gzip = gzip;
+  }
+
+  _image = image;
+  _imageSize = size;
+
+  _bundle.assets = _assets;
+  _bundle.displacements = displacements;
+  _bundle.slots = slots;
+  _bundle.size = count;
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+
+#if defined(ESP32)
+
+bool AsyncAssetStore::begin(const char* name)
+{
+  end();
+
+  const esp_partition_t* partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, name);
+
+  if (!partition)
+  {
+    AWS_LOGERROR1("AsyncAssetStore: no data partition", name);
+
+    return false;
+  }
+
+  uint32_t header[ASSET_HEADER_SIZE / 4];
+
+  if ( (esp_partition_read(partition, 0, header, sizeof(header)) != ESP_OK) || (header[0] != ASSET_IMAGE_MAGIC)
+       || ((header[1] & 0xFFFF) != ASSET_IMAGE_VERSION) || (header[3] < ASSET_HEADER_SIZE) || (header[3] > partition->size) )
+  {
+    AWS_LOGERROR1("AsyncAssetStore: no asset image in", name);
+
+    return false;
+  }
+
+  // Mapped through the flash cache : data is read in place, never copied to RAM
+  const void* image;
+  spi_flash_mmap_handle_t handle;
+
+  if (esp_partition_mmap(partition, 0, header[3], SPI_FLASH_MMAP_DATA, &image, &handle) != ESP_OK)
+  {
+    AWS_LOGERROR("AsyncAssetStore: mmap failed");
+
+    return false;
+  }
+
+  if (!_load((const uint8_t*) image, header[3]))
+  {
+    spi_flash_munmap(handle);
+
+    return false;
+  }
+
+  _map = (void*) (uintptr_t) handle;
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+
+void AsyncAssetStore::end()
+{
+  if (_image)
+    spi_flash_munmap((spi_flash_mmap_handle_t) (uintptr_t) _map);
+
+  free(_assets);
+
+  _image = nullptr;
+  _imageSize = 0;
+  _map = nullptr;
+  _assets = nullptr;
+  _bundle = {nullptr, nullptr, nullptr, 0};
+}
+
+/////////////////////////////////////////////////
+
+#else
+
+bool AsyncAssetStore::begin(const char* name)
+{
+  end();
+
+  const int fd = open(name, O_RDONLY);
+
+  if (fd < 0)
+    return false;
+
+  struct stat info;
+  uint32_t header[ASSET_HEADER_SIZE / 4];
+  void* image = MAP_FAILED;
+
+  if ( (fstat(fd, &info) == 0) && (pread(fd, header, sizeof(header), 0) == (ssize_t) sizeof(header))
+       && (header[0] == ASSET_IMAGE_MAGIC) && ((header[1] & 0xFFFF) == ASSET_IMAGE_VERSION)
+       && (header[3] >= ASSET_HEADER_SIZE) && (header[3] <= (uint64_t) info.st_size) )
+  {
+    image = mmap(nullptr, header[3], PROT_READ, MAP_SHARED, fd, 0);
+  }
+
+  // The mapping outlives the descriptor
+  close(fd);
+
+  if (image == MAP_FAILED)
+    return false;
+
+  if (!_load((const uint8_t*) image, header[3]))
+  {
+    munmap(image, header[3]);
+
+    return false;
+  }
+
+  _map = image;
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+
+void AsyncAssetStore::end()
+{
+  if (_image)
+    munmap(_map, _imageSize);
+
+  free(_assets);
+
+  _image = nullptr;
+  _imageSize = 0;
+  _map = nullptr;
+  _assets = nullptr;
+  _bundle = {nullptr, nullptr, nullptr, 0};
+}
+
+#endif
+
+/////////////////////////////////////////////////
+
+}
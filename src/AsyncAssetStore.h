@@ -0,0 +1,182 @@
+/****************************************************************************************************************************
+  AsyncAssetStore.h - Dead simple Ethernet AsyncWebServer.
+
+  For LAN8720 Ethernet in WT32_ETH01 (ESP32 + LAN8720)
+
+  AsyncWebServer_WT32_ETH01 is a library for the Ethernet LAN8720 in WT32_ETH01 to run AsyncWebServer
+
+  Based on and modified from ESPAsyncWebServer (https://github.com/me-no-dev/ESPAsyncWebServer)
+  Built by Khoi Hoang https://github.com/khoih-prog/AsyncWebServer_WT32_ETH01
+  Licensed under GPLv3 license
+
+  Original author: Hristo Gochkov
+
+  Copyright (c) 2016 Hristo Gochkov. All rights reserved.
+
+  This library is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License along with this library;
+  if not, write to the Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+  Version: 1.6.2
+
+  Version Modified By   Date      Comments
+  ------- -----------  ---------- -----------
+  1.2.3   K Hoang      17/07/2021 Initial porting for WT32_ETH01 (ESP32 + LAN8720). Sync with ESPAsyncWebServer v1.2.3
+  1.2.4   K Hoang      02/08/2021 Fix Mbed TLS compile error with ESP32 core v2.0.0-rc1+
+  1.2.5   K Hoang      09/10/2021 Update `platform.ini` and `library.json`Working only with core v1.0.6-
+  1.3.0   K Hoang      23/10/2021 Making compatible with breaking core v2.0.0+
+  1.4.0   K Hoang      27/11/2021 Auto detect ESP32 core version
+  1.4.1   K Hoang      29/11/2021 Fix bug in examples to reduce connection time
+  1.5.0   K Hoang      01/10/2022 Fix AsyncWebSocket bug
+  1.6.0   K Hoang      04/10/2022 Option to use cString instead of String to save Heap
+  1.6.1   K Hoang      05/10/2022 Don't need memmove(), String no longer destroyed
+  1.6.2   K Hoang      10/11/2022 Add examples to demo how to use beginChunkedResponse() to send in chunks
+ *****************************************************************************************************************************/
+/*
+  Read-only asset store, memory mapped from a raw data partition (ESP32) or a file (Linux, for host benchmarks)
+
+  The image is built by utils/embed_assets.py --image, and holds the same data as an embedded bundle : for each
+  URL its response headers, its content and ETag, plus the perfect hash table. Served zero-copy with
+  AsyncEmbeddedWebHandler(store).
+
+  Example, with a partition "assets, data, 0x40, , 0x100000" in partitions.csv
+
+  python3 utils/embed_assets.py --image data assets.bin
+  parttool.py write_partition --partition-name assets --input assets.bin
+
+  AsyncAssetStore assets;
+
+  if (assets.begin("assets"))
+    server.addHandler(new AsyncEmbeddedWebHandler(assets));
+*/
+
+#ifndef ASYNC_ASSET_STORE_H_
+#define ASYNC_ASSET_STORE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+/////////////////////////////////////////////////
+
+// Image layout, little endian, all offsets from the start of the image and 4 bytes aligned :
+//   header        : magic "AWSA", uint16 version, uint16 reserved, uint32 count, uint32 image size
+//   displacements : int32[count]
+//   slots         : uint16[count], padded to 4 bytes
+//   records       : count * { uint32 url, head, headLength, content, contentLength, etag, notModifiedLength, gzip }
+//   blobs         : URLs and ETags (NUL terminated), heads and contents
+#define ASSET_IMAGE_MAGIC           0x41535741    // "AWSA"
+#define ASSET_IMAGE_VERSION         2
+
+namespace eth {
+
+/////////////////////////////////////////////////
+
+typedef struct
+{
+  const char* url;
+  const uint8_t* head;          // Headers, without the status line nor the empty line ending the head
+  size_t headLength;
+  size_t notModifiedLength;     // Leading headers also sent with a 304 : Cache-Control, Vary, ETag, Connection
+  const uint8_t* content;
+  size_t contentLength;
+  const char* etag;
+  bool gzip;                    // Content is gzip encoded, with no identity copy
+} AwsEmbeddedAsset;
+
+/////////////////////////////////////////////////
+
+typedef struct
+{
+  const AwsEmbeddedAsset* assets;
+  const int32_t* displacements; // Perfect hash : < 0 gives -(slot + 1) directly, else the seed of the second hash
+  const uint16_t* slots;        // Slot to asset index
+  size_t size;
+} AwsEmbeddedBundle;
+
+/////////////////////////////////////////////////
+
+// FNV-1a variant shared with utils/embed_assets.py : the tables are only valid with this exact function
+inline uint32_t embeddedAssetHash(uint32_t seed, const char* key)
+{
+  uint32_t hash = seed ? seed : 0x01000193;
+
+  while (*key)
+    hash = (hash * 0x01000193) ^ (uint8_t) *key++;
+
+  return hash;
+}
+
+/////////////////////////////////////////////////
+
+inline const AwsEmbeddedAsset* findEmbeddedAsset(const AwsEmbeddedBundle& bundle, const char* url)
+{
+  if (!bundle.size)
+    return nullptr;
+
+  const int32_t displacement = bundle.displacements[embeddedAssetHash(0, url) % bundle.size];
+  const size_t slot = (displacement < 0) ? (size_t) (-displacement - 1) : embeddedAssetHash(displacement, url) % bundle.size;
+  const AwsEmbeddedAsset* asset = &bundle.assets[bundle.slots[slot]];
+
+  // Any URL hashes somewhere : check it is the one stored there
+  return strcmp(asset->url, url) ? nullptr : asset;
+}
+
+/////////////////////////////////////////////////
+
+/*
+   AsyncAssetStore :: Maps an asset image and exposes it as an AwsEmbeddedBundle
+ * */
+
+class AsyncAssetStore
+{
+  private:
+    const uint8_t* _image;
+    size_t _imageSize;
+    void* _map;                   // Mapping handle (ESP32) or address (Linux)
+    AwsEmbeddedAsset* _assets;    // Pointers into the image, built once at begin()
+    AwsEmbeddedBundle _bundle;
+
+    bool _load(const uint8_t* image, size_t available);
+
+  public:
+    AsyncAssetStore();
+    ~AsyncAssetStore();
+
+    // ESP32 : label of the data partition holding the image. Linux : path of the image file
+    bool begin(const char* name);
+
+    // Responses in flight point into the image : only unmap once the server is stopped
+    void end();
+
+    bool mounted() const
+    {
+      return _image != nullptr;
+    }
+
+    size_t imageSize() const
+    {
+      return _imageSize;
+    }
+
+    const AwsEmbeddedBundle& bundle() const
+    {
+      return _bundle;
+    }
+
+    const AwsEmbeddedAsset* find(const char* url) const
+    {
+      return findEmbeddedAsset(_bundle, url);
+    }
+};
+
+/////////////////////////////////////////////////
+
+}
+
+#endif    // ASYNC_ASSET_STORE_H_
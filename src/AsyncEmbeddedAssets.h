@@ -0,0 +1,202 @@
+/****************************************************************************************************************************
+  AsyncEmbeddedAssets.h - Dead simple Ethernet AsyncWebServer.
+
+  For LAN8720 Ethernet in WT32_ETH01 (ESP32 + LAN8720)
+
+  AsyncWebServer_WT32_ETH01 is a library for the Ethernet LAN8720 in WT32_ETH01 to run AsyncWebServer
+
+  Based on and modified from ESPAsyncWebServer (https://github.com/me-no-dev/ESPAsyncWebServer)
+  Built by Khoi Hoang https://github.com/khoih-prog/AsyncWebServer_WT32_ETH01
+  Licensed under GPLv3 license
+
+  Original author: Hristo Gochkov
+
+  Copyright (c) 2016 Hristo Gochkov. All rights reserved.
+
+  This library is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License along with this library;
+  if not, write to the Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+  Version: 1.6.2
+
+  Version Modified By   Date      Comments
+  ------- -----------  ---------- -----------
+  1.2.3   K Hoang      17/07/2021 Initial porting for WT32_ETH01 (ESP32 + LAN8720). Sync with ESPAsyncWebServer v1.2.3
+  1.2.4   K Hoang      02/08/2021 Fix Mbed TLS compile error with ESP32 core v2.0.0-rc1+
+  1.2.5   K Hoang      09/10/2021 Update `platform.ini` and `library.json`Working only with core v1.0.6-
+  1.3.0   K Hoang      23/10/2021 Making compatible with breaking core v2.0.0+
+  1.4.0   K Hoang      27/11/2021 Auto detect ESP32 core version
+  1.4.1   K Hoang      29/11/2021 Fix bug in examples to reduce connection time
+  1.5.0   K Hoang      01/10/2022 Fix AsyncWebSocket bug
+  1.6.0   K Hoang      04/10/2022 Option to use cString instead of String to save Heap
+  1.6.1   K Hoang      05/10/2022 Don't need memmove(), String no longer destroyed
+  1.6.2   K Hoang      10/11/2022 Add examples to demo how to use beginChunkedResponse() to send in chunks
+ *****************************************************************************************************************************/
+/*
+  Static files embedded in flash at build time
+
+  utils/embed_assets.py turns a data/ directory into a header holding, for each file, its (gzipped) content,
+  its response headers with MIME type and strong ETag, and a perfect hash table of the URLs.
+  Gzipped content has no identity copy : clients not accepting gzip get 406 Not Acceptable.
+
+  Example
+
+  #include "embedded_assets.h"    // python3 utils/embed_assets.py data embedded_assets.h
+
+  server.addHandler(new AsyncEmbeddedWebHandler(embeddedAssets));
+*/
+
+#ifndef ASYNC_EMBEDDED_ASSETS_H_
+#define ASYNC_EMBEDDED_ASSETS_H_
+
+#include "AsyncWebServer_WT32_ETH01.h"
+#include "AsyncAssetStore.h"
+
+namespace eth {
+
+/////////////////////////////////////////////////
+
+/*
+   AsyncEmbeddedResponse :: Sends the status line, headers and content straight from flash, only the default
+   headers are built. A 304 sends the leading headers only, and no content
+ * */
+
+class AsyncEmbeddedResponse: public AsyncScatterGatherResponse
+{
+  public:
+    AsyncEmbeddedResponse(const AwsEmbeddedAsset& asset, uint8_t version, bool notModified = false)
+      : AsyncScatterGatherResponse(notModified ? 304 : 200)
+    {
+      if (notModified)
+        addFlash(version ? PSTR("HTTP/1.1 304 Not Modified\r\n") : PSTR("HTTP/1.0 304 Not Modified\r\n"));
+      else
+        addFlash(version ? PSTR("HTTP/1.1 200 OK\r\n") : PSTR("HTTP/1.0 200 OK\r\n"));
+
+      addFlash(asset.head, notModified ? asset.notModifiedLength : asset.headLength);
+
+      // DefaultHeaders, then the empty line ending the head
+      String tail;
+
+      for (const auto& header : _headers)
+      {
+        tail += header->name() + ": " + header->value() + "\r\n";
+      }
+
+      _headers.free();
+      tail += "\r\n";
+
+      addOwned(tail);
+
+      if (!notModified)
+        addFlash(asset.content, asset.contentLength);
+    }
+
+    /////////////////////////////////////////////////
+
+    // The head is part of the segments
+    virtual String _assembleHead(uint8_t version __attribute__((unused))) override
+    {
+      _headers.free();
+
+      return String();
+    }
+};
+
+/////////////////////////////////////////////////
+
+class AsyncEmbeddedWebHandler: public AsyncWebHandler
+{
+  private:
+    const AwsEmbeddedBundle& _bundle;
+    String _uri;
+
+    /////////////////////////////////////////////////
+
+    const AwsEmbeddedAsset* _find(AsyncWebServerRequest *request)
+    {
+      const String& url = request->url();
+
+      if (!url.startsWith(_uri))
+        return nullptr;
+
+      return findEmbeddedAsset(_bundle, url.c_str() + _uri.length());
+    }
+
+  public:
+    // uri : where the bundle is mounted, "" for the root
+    AsyncEmbeddedWebHandler(const AwsEmbeddedBundle& bundle, const char* uri = ""): _bundle(bundle), _uri(uri)
+    {
+      if (_uri.endsWith("/"))
+        _uri = _uri.substring(0, _uri.length() - 1);
+    }
+
+    // Image mapped by an AsyncAssetStore, nothing is served while it is not mounted
+    AsyncEmbeddedWebHandler(const AsyncAssetStore& store, const char* uri = ""): AsyncEmbeddedWebHandler(store.bundle(), uri) {}
+
+    /////////////////////////////////////////////////
+
+    virtual bool canHandle(AsyncWebServerRequest *request) override final
+    {
+      if (request->method() != HTTP_GET || !_find(request))
+        return false;
+
+      request->addInterestingHeader("If-None-Match");
+      request->addInterestingHeader("Accept-Encoding");
+
+      return true;
+    }
+
+    /////////////////////////////////////////////////
+
+    virtual void handleRequest(AsyncWebServerRequest *request) override final
+    {
+      if ((_username != "" && _password != "") && !request->authenticate(_username.c_str(), _password.c_str()))
+        return request->requestAuthentication();
+
+      const AwsEmbeddedAsset* asset = _find(request);
+
+      if (!asset)
+      {
+        request->send(404);
+
+        return;
+      }
+
+      // No identity copy to fall back to
+      if (asset->gzip && !request->acceptsEncoding("gzip"))
+      {
+        AsyncWebServerResponse * response = new AsyncBasicResponse(406); // Not acceptable
+
+        response->addHeader("Vary", "Accept-Encoding");
+        request->send(response);
+
+        return;
+      }
+
+      if (request->hasHeader("If-None-Match"))
+      {
+        const String& ifNoneMatch = request->header("If-None-Match");
+
+        if (ifNoneMatch == "*" || ifNoneMatch.indexOf(asset->etag) >= 0)
+        {
+          // Not modified : Cache-Control, Vary and ETag as with a 200
+          request->send(new AsyncEmbeddedResponse(*asset, request->version(), true));
+
+          return;
+        }
+      }
+
+      request->send(new AsyncEmbeddedResponse(*asset, request->version()));
+    }
+};
+
+/////////////////////////////////////////////////
+
+}
+
+#endif    // ASYNC_EMBEDDED_ASSETS_H_
@@ -69,6 +69,24 @@
   });
   server.addHandler(handler);
 
+  Streaming, for large bodies : values are handed out as they are parsed, see AsyncJsonParser.h
+
+  handler->onValue([](AsyncWebServerRequest *request, const char* path, AwsJsonType type, const char* value) {
+    if (!strcmp(path, "wifi.ssid"))
+      ...
+  });
+
+  --------------------
+
+  MessagePack (ArduinoJson 6) : same documents, negotiated on Content-Type and Accept
+
+  server.addHandler(new AsyncCallbackMsgPackWebHandler("/telemetry", [](AsyncWebServerRequest *request, JsonVariant &json) {
+    AsyncJsonResponse * response = beginJsonResponse(request);    // AsyncMsgPackResponse if Accept has application/msgpack
+    response->getRoot()["stored"] = true;
+    response->setLength();
+    request->send(response);
+  }));
+
 */
 
 #ifndef ASYNC_JSON_H_
@@ -77,9 +95,12 @@
 #include <ArduinoJson.h>
 
 #include "AsyncWebServer_WT32_ETH01.h"
+#include "AsyncJsonParser.h"
 
 #include <Print.h>
 
+#include <new>
+
 namespace eth {
 
 /////////////////////////////////////////////////
@@ -95,6 +116,7 @@ namespace eth {
 /////////////////////////////////////////////////
 
 constexpr const char* JSON_MIMETYPE = "application/json";
+constexpr const char* MSGPACK_MIMETYPE = "application/msgpack";
 
 /////////////////////////////////////////////////
 
@@ -147,6 +169,49 @@ class ChunkPrint : public Print
 
 /////////////////////////////////////////////////
 
+// Print into a SegmentedBuffer, used to serialise a document once
+class SegmentedPrint : public Print
+{
+  private:
+    SegmentedBuffer& _buffer;
+    bool _overflow;
+
+  public:
+    SegmentedPrint(SegmentedBuffer& buffer) : _buffer(buffer), _overflow(false) {}
+
+    virtual ~SegmentedPrint() {}
+
+    /////////////////////////////////////////////////
+
+    inline bool overflow() const
+    {
+      return _overflow;
+    }
+
+    /////////////////////////////////////////////////
+
+    size_t write(uint8_t c)
+    {
+      return write(&c, 1);
+    }
+
+    /////////////////////////////////////////////////
+
+    size_t write(const uint8_t *buffer, size_t size)
+    {
+      if (_overflow)
+        return 0;
+
+      size_t written = _buffer.write(buffer, size);
+
+      if (written < size)
+        _overflow = true;
+
+      return written;
+    }
+};
+
+/////////////////////////////////////////////////
 /////////////////////////////////////////////////
 
 class AsyncJsonResponse: public AsyncAbstractResponse
@@ -162,12 +227,41 @@ class AsyncJsonResponse: public AsyncAbstractResponse
     JsonVariant _root;
     bool _isValid;
 
+    SegmentedBuffer _buffer;
+    bool _serialized;
+    bool _buffered;
+    size_t _plainLength;    // JSON bytes handed out : _sentLength counts compressed ones with setCompression()
+
+    /////////////////////////////////////////////////
+
+    virtual void _serialize(Print& dest)
+    {
+#ifdef ARDUINOJSON_5_COMPATIBILITY
+      _root.printTo(dest);
+#else
+      serializeJson(_root, dest);
+#endif
+    }
+
+    /////////////////////////////////////////////////
+
+    // Length of what _serialize() writes
+    virtual size_t _measure()
+    {
+#ifdef ARDUINOJSON_5_COMPATIBILITY
+      return _root.measureLength();
+#else
+      return measureJson(_root);
+#endif
+    }
+
   public:
 
     /////////////////////////////////////////////////
 
 #ifdef ARDUINOJSON_5_COMPATIBILITY
-    AsyncJsonResponse(bool isArray = false): _isValid {false}
+    AsyncJsonResponse(bool isArray = false): _isValid {false}, _serialized {false}, _buffered {true},
+      _plainLength {0}
     {
       _code = 200;
       _contentType = JSON_MIMETYPE;
@@ -179,7 +273,8 @@ class AsyncJsonResponse: public AsyncAbstractResponse
     }
 #else
     AsyncJsonResponse(bool isArray = false,
-                      size_t maxJsonBufferSize = DYNAMIC_JSON_DOCUMENT_SIZE) : _jsonBuffer(maxJsonBufferSize), _isValid {false}
+                      size_t maxJsonBufferSize = DYNAMIC_JSON_DOCUMENT_SIZE) : _jsonBuffer(maxJsonBufferSize), _isValid {false},
+      _serialized {false}, _buffered {true}, _plainLength {0}
     {
       _code = 200;
       _contentType = JSON_MIMETYPE;
@@ -213,12 +308,7 @@ class AsyncJsonResponse: public AsyncAbstractResponse
 
     size_t setLength()
     {
-
-#ifdef ARDUINOJSON_5_COMPATIBILITY
-      _contentLength = _root.measureLength();
-#else
-      _contentLength = measureJson(_root);
-#endif
+      _contentLength = _measure();
 
       if (_contentLength)
       {
@@ -237,15 +327,46 @@ class AsyncJsonResponse: public AsyncAbstractResponse
 
     /////////////////////////////////////////////////
 
+    // The document is serialised once, on the first call, then handed out from the pooled segments.
+    // Without the memory for it, fall back to serialising again for each chunk and skipping what was sent.
     size_t _fillBuffer(uint8_t *data, size_t len)
     {
-      ChunkPrint dest(data, _sentLength, len);
+      if (!_serialized)
+      {
+        SegmentedPrint dest(_buffer);
+
+        _serialize(dest);
+        _serialized = true;
+
+        if (dest.overflow() || (_buffer.size() != _contentLength))
+        {
+          AWS_LOGDEBUG1("AsyncJsonResponse: can't buffer, serialising per chunk, length =", _contentLength);
+
+          _buffer.clear();
+          _buffered = false;
+        }
+      }
+
+      if (_buffered)
+      {
+        const size_t readLen = _buffer.read(data, len);
+
+        _plainLength += readLen;
+
+        return readLen;
+      }
+
+      if (_plainLength >= _contentLength)
+        return 0;
+
+      if (len > _contentLength - _plainLength)
+        len = _contentLength - _plainLength;
+
+      ChunkPrint dest(data, _plainLength, len);
+
+      _serialize(dest);
+      _plainLength += len;
 
-#ifdef ARDUINOJSON_5_COMPATIBILITY
-      _root.printTo( dest ) ;
-#else
-      serializeJson(_root, dest);
-#endif
       return len;
     }
 
@@ -268,42 +389,133 @@ class PrettyAsyncJsonResponse: public AsyncJsonResponse
 
     /////////////////////////////////////////////////
 
-    size_t setLength ()
+  protected:
+
+    void _serialize(Print& dest) override
     {
 #ifdef ARDUINOJSON_5_COMPATIBILITY
-      _contentLength = _root.measurePrettyLength ();
+      _root.prettyPrintTo (dest);
 #else
-      _contentLength = measureJsonPretty(_root);
+      serializeJsonPretty(_root, dest);
 #endif
-
-      if (_contentLength)
-      {
-        _isValid = true;
-      }
-
-      return _contentLength;
     }
 
     /////////////////////////////////////////////////
 
-    size_t _fillBuffer (uint8_t *data, size_t len)
+    size_t _measure() override
     {
-      ChunkPrint dest (data, _sentLength, len);
-
 #ifdef ARDUINOJSON_5_COMPATIBILITY
-      _root.prettyPrintTo (dest);
+      return _root.measurePrettyLength ();
 #else
-      serializeJsonPretty(_root, dest);
+      return measureJsonPretty(_root);
 #endif
+    }
+};
 
-      return len;
+/////////////////////////////////////////////////
+
+// Accept lists application/msgpack (or application/x-msgpack) without q=0. Needs the Accept header kept,
+// e.g. request->addInterestingHeader("Accept") in canHandle().
+inline bool acceptsMsgPack(AsyncWebServerRequest *request)
+{
+  const String& accept = request->header("Accept");
+  int start = 0;
+
+  while (start < (int) accept.length())
+  {
+    int end = accept.indexOf(',', start);
+
+    if (end < 0)
+      end = accept.length();
+
+    String type = accept.substring(start, end);
+    start = end + 1;
+
+    float quality = 1;
+    int semicolon = type.indexOf(';');
+
+    if (semicolon >= 0)
+    {
+      int q = type.indexOf("q=", semicolon);
+
+      if (q >= 0)
+        quality = type.substring(q + 2).toFloat();
+
+      type = type.substring(0, semicolon);
+    }
+
+    type.trim();
+
+    if (type.equalsIgnoreCase(MSGPACK_MIMETYPE) || type.equalsIgnoreCase("application/x-msgpack"))
+      return quality > 0;
+  }
+
+  return false;
+}
+
+/////////////////////////////////////////////////
+
+inline bool isMsgPackContentType(const String& contentType)
+{
+  return contentType.equalsIgnoreCase(MSGPACK_MIMETYPE) || contentType.equalsIgnoreCase("application/x-msgpack");
+}
+
+/////////////////////////////////////////////////
+
+// ArduinoJson 6 only : application/msgpack, for the same document as AsyncJsonResponse
+#ifndef ARDUINOJSON_5_COMPATIBILITY
+
+/////////////////////////////////////////////////
+/////////////////////////////////////////////////
+
+class AsyncMsgPackResponse: public AsyncJsonResponse
+{
+  public:
+    AsyncMsgPackResponse(bool isArray = false,
+                         size_t maxJsonBufferSize = DYNAMIC_JSON_DOCUMENT_SIZE) : AsyncJsonResponse {isArray, maxJsonBufferSize}
+    {
+      _contentType = MSGPACK_MIMETYPE;
+    }
+
+    /////////////////////////////////////////////////
+
+  protected:
+
+    void _serialize(Print& dest) override
+    {
+      serializeMsgPack(_root, dest);
+    }
+
+    /////////////////////////////////////////////////
+
+    size_t _measure() override
+    {
+      return measureMsgPack(_root);
     }
 };
 
 /////////////////////////////////////////////////
 
+// MessagePack when the client accepts it, else JSON. Fill getRoot() then setLength() as usual.
+inline AsyncJsonResponse* beginJsonResponse(AsyncWebServerRequest *request, bool isArray = false,
+                                            size_t maxJsonBufferSize = DYNAMIC_JSON_DOCUMENT_SIZE)
+{
+  if (acceptsMsgPack(request))
+    return new AsyncMsgPackResponse(isArray, maxJsonBufferSize);
+
+  return new AsyncJsonResponse(isArray, maxJsonBufferSize);
+}
+
+#endif    // ARDUINOJSON_5_COMPATIBILITY
+
+/////////////////////////////////////////////////
+
 typedef std::function<void(AsyncWebServerRequest *request, JsonVariant &json)> ArJsonRequestHandlerFunction;
 
+// Streaming mode : each value of the body, see AsyncJsonParser.h
+typedef std::function<void(AsyncWebServerRequest *request, const char* path, AwsJsonType type, const char* value)>
+ArJsonValueHandlerFunction;
+
 /////////////////////////////////////////////////
 /////////////////////////////////////////////////
 
@@ -314,6 +526,7 @@ class AsyncCallbackJsonWebHandler: public AsyncWebHandler
     const String _uri;
     WebRequestMethodComposite _method;
     ArJsonRequestHandlerFunction _onRequest;
+    ArJsonValueHandlerFunction _onValue;
     size_t _contentLength;
 
 #ifndef ARDUINOJSON_5_COMPATIBILITY
@@ -321,6 +534,22 @@ class AsyncCallbackJsonWebHandler: public AsyncWebHandler
 #endif
 
     size_t _maxContentLength;
+    bool _msgPack;              // Also takes application/msgpack bodies
+
+    /////////////////////////////////////////////////
+
+    inline bool _isMsgPack(AsyncWebServerRequest *request)
+    {
+      return _msgPack && isMsgPackContentType(request->contentType());
+    }
+
+    /////////////////////////////////////////////////
+
+    // AsyncJsonParser reads JSON only, MessagePack bodies are always buffered
+    inline bool _isStreaming(AsyncWebServerRequest *request)
+    {
+      return _onValue && !_isMsgPack(request);
+    }
 
   public:
 
@@ -328,12 +557,13 @@ class AsyncCallbackJsonWebHandler: public AsyncWebHandler
 
 #ifdef ARDUINOJSON_5_COMPATIBILITY
     AsyncCallbackJsonWebHandler(const String& uri, ArJsonRequestHandlerFunction onRequest)
-      : _uri(uri), _method(HTTP_POST | HTTP_PUT | HTTP_PATCH), _onRequest(onRequest), _maxContentLength(16384) {}
+      : _uri(uri), _method(HTTP_POST | HTTP_PUT | HTTP_PATCH), _onRequest(onRequest), _maxContentLength(16384),
+        _msgPack(false) {}
 #else
     AsyncCallbackJsonWebHandler(const String& uri, ArJsonRequestHandlerFunction onRequest,
                                 size_t maxJsonBufferSize = DYNAMIC_JSON_DOCUMENT_SIZE)
       : _uri(uri), _method(HTTP_POST | HTTP_PUT | HTTP_PATCH), _onRequest(onRequest), maxJsonBufferSize(maxJsonBufferSize),
-        _maxContentLength(16384) {}
+        _maxContentLength(16384), _msgPack(false) {}
 #endif
 
     /////////////////////////////////////////////////
@@ -359,6 +589,15 @@ class AsyncCallbackJsonWebHandler: public AsyncWebHandler
 
     /////////////////////////////////////////////////
 
+    // Streaming mode : the body is parsed as it arrives and never held in memory, nor limited by setMaxContentLength().
+    // fn gets each value with its path, then onRequest() is called with a null json once the body is complete and valid.
+    inline void onValue(ArJsonValueHandlerFunction fn)
+    {
+      _onValue = fn;
+    }
+
+    /////////////////////////////////////////////////
+
     virtual bool canHandle(AsyncWebServerRequest *request) override final
     {
       if (!_onRequest)
@@ -370,7 +609,7 @@ class AsyncCallbackJsonWebHandler: public AsyncWebHandler
       if (_uri.length() && (_uri != request->url() && !request->url().startsWith(_uri + "/")))
         return false;
 
-      if ( !request->contentType().equalsIgnoreCase(JSON_MIMETYPE) )
+      if ( !request->contentType().equalsIgnoreCase(JSON_MIMETYPE) && !_isMsgPack(request) )
         return false;
 
       request->addInterestingHeader("ANY");
@@ -382,7 +621,40 @@ class AsyncCallbackJsonWebHandler: public AsyncWebHandler
 
     virtual void handleRequest(AsyncWebServerRequest *request) override final
     {
-      if (_onRequest)
+      if (_onRequest && _isStreaming(request))
+      {
+        AsyncJsonParser* parser = (AsyncJsonParser*) request->_tempObject;
+
+        auto onValue = [this, request](const char* path, AwsJsonType type, const char* value)
+        {
+          _onValue(request, path, type, value);
+        };
+
+        if (parser && parser->finish(onValue))
+        {
+          JsonVariant json;
+
+          _onRequest(request, json);
+
+          return;
+        }
+
+        if (!parser && request->contentLength())
+        {
+          // The parser could not be allocated : the body was never looked at, not the client's fault
+          request->send(503);
+
+          return;
+        }
+
+        if (parser)
+        {
+          AWS_LOGDEBUG3("AsyncCallbackJsonWebHandler: JSON error", parser->error(), "at", parser->errorOffset());
+        }
+
+        request->send(400);
+      }
+      else if (_onRequest)
       {
         if (request->_tempObject != NULL)
         {
@@ -394,8 +666,11 @@ class AsyncCallbackJsonWebHandler: public AsyncWebHandler
           if (json.success())
           {
 #else
+          // The body is not NUL terminated
           DynamicJsonDocument jsonBuffer(this->maxJsonBufferSize);
-          DeserializationError error = deserializeJson(jsonBuffer, (uint8_t*)(request->_tempObject));
+          DeserializationError error = _isMsgPack(request) ?
+                                       deserializeMsgPack(jsonBuffer, (uint8_t*)(request->_tempObject), request->contentLength()) :
+                                       deserializeJson(jsonBuffer, (uint8_t*)(request->_tempObject), request->contentLength());
 
           if (!error)
           {
@@ -428,7 +703,32 @@ class AsyncCallbackJsonWebHandler: public AsyncWebHandler
     virtual void handleBody(AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index,
                             size_t total) override final
     {
-      if (_onRequest)
+      if (_onRequest && _isStreaming(request))
+      {
+        _contentLength = total;
+
+        // The parser has no destructor, the request free()s it
+        if (index == 0 && request->_tempObject == NULL)
+        {
+          void* memory = malloc(sizeof(AsyncJsonParser));
+
+          if (memory)
+            request->_tempObject = new (memory) AsyncJsonParser();
+          else
+            AWS_LOGERROR1("AsyncCallbackJsonWebHandler: parser malloc failed, size =", sizeof(AsyncJsonParser));
+        }
+
+        if (request->_tempObject != NULL)
+        {
+          auto onValue = [this, request](const char* path, AwsJsonType type, const char* value)
+          {
+            _onValue(request, path, type, value);
+          };
+
+          ((AsyncJsonParser*) request->_tempObject)->parse(data, len, onValue);
+        }
+      }
+      else if (_onRequest)
       {
         _contentLength = total;
 
@@ -452,6 +752,27 @@ class AsyncCallbackJsonWebHandler: public AsyncWebHandler
     }
 };
 
+/////////////////////////////////////////////////
+
+#ifndef ARDUINOJSON_5_COMPATIBILITY
+
+/////////////////////////////////////////////////
+
+// Takes application/msgpack as well as application/json bodies, into the same JsonVariant.
+// Answer with beginJsonResponse(request) to reply in the format the client accepts.
+class AsyncCallbackMsgPackWebHandler: public AsyncCallbackJsonWebHandler
+{
+  public:
+    AsyncCallbackMsgPackWebHandler(const String& uri, ArJsonRequestHandlerFunction onRequest,
+                                   size_t maxJsonBufferSize = DYNAMIC_JSON_DOCUMENT_SIZE)
+      : AsyncCallbackJsonWebHandler(uri, onRequest, maxJsonBufferSize)
+    {
+      _msgPack = true;
+    }
+};
+
+#endif    // ARDUINOJSON_5_COMPATIBILITY
+
 }
 
 #endif
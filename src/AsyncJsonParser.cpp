@@ -0,0 +1,586 @@
+/****************************************************************************************************************************
+  AsyncJsonParser.cpp - Dead simple Ethernet AsyncWebServer.
+
+  For LAN8720 Ethernet in WT32_ETH01 (ESP32 + LAN8720)
+
+  AsyncWebServer_WT32_ETH01 is a library for the Ethernet LAN8720 in WT32_ETH01 to run AsyncWebServer
+
+  Based on and modified from ESPAsyncWebServer (https://github.com/me-no-dev/ESPAsyncWebServer)
+  Built by Khoi Hoang https://github.com/khoih-prog/AsyncWebServer_WT32_ETH01
+  Licensed under GPLv3 license
+
+  Original author: Hristo Gochkov
+
+  Copyright (c) 2016 Hristo Gochkov. All rights reserved.
+
+  This library is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License along with this library;
+  if not, write to the Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+  Version: 1.6.2
+
+  Version Modified By   Date      Comments
+  ------- -----------  ---------- -----------
+  1.2.3   K Hoang      17/07/2021 Initial porting for WT32_ETH01 (ESP32 + LAN8720). Sync with ESPAsyncWebServer v1.2.3
+  1.2.4   K Hoang      02/08/2021 Fix Mbed TLS compile error with ESP32 core v2.0.0-rc1+
+  1.2.5   K Hoang      09/10/2021 Update `platform.ini` and `library.json`Working only with core v1.0.6-
+  1.3.0   K Hoang      23/10/2021 Making compatible with breaking core v2.0.0+
+  1.4.0   K Hoang      27/11/2021 Auto detect ESP32 core version
+  1.4.1   K Hoang      29/11/2021 Fix bug in examples to reduce connection time
+  1.5.0   K Hoang      01/10/2022 Fix AsyncWebSocket bug
+  1.6.0   K Hoang      04/10/2022 Option to use cString instead of String to save Heap
+  1.6.1   K Hoang      05/10/2022 Don't need memmove(), String no longer destroyed
+  1.6.2   K Hoang      10/11/2022 Add examples to demo how to use beginChunkedResponse() to send in chunks
+ *****************************************************************************************************************************/
+
+#include "AsyncJsonParser.h"
+
+#include <stdio.h>
+
+#include <type_traits>
+
+namespace eth {
+
+/////////////////////////////////////////////////
+
+// Kept in request->_tempObject, which is free()d
+static_assert(std::is_trivially_destructible<AsyncJsonParser>::value, "AsyncJsonParser must not need a destructor");
+
+/////////////////////////////////////////////////
+
+typedef enum
+{
+  JSON_STATE_VALUE,           // Root, after ':' or after ',' in an array
+  JSON_STATE_ARRAY_FIRST,     // After '[' : value or ']'
+  JSON_STATE_OBJECT_FIRST,    // After '{' : name or '}'
+  JSON_STATE_KEY,             // After ',' in an object
+  JSON_STATE_COLON,
+  JSON_STATE_AFTER,           // After a value in a container : ',' or closing
+  JSON_STATE_STRING,
+  JSON_STATE_ESCAPE,
+  JSON_STATE_UNICODE,
+  JSON_STATE_NUMBER,
+  JSON_STATE_LITERAL,
+  JSON_STATE_DONE
+} AwsJsonState;
+
+/////////////////////////////////////////////////
+
+static inline bool isJsonSpace(char c)
+{
+  return (c == ' ' || c == '\t' || c == '\r' || c == '\n');
+}
+
+/////////////////////////////////////////////////
+
+static inline bool isDigit(char c)
+{
+  return (c >= '0' && c <= '9');
+}
+
+/////////////////////////////////////////////////
+
+// -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+static bool isJsonNumber(const char* s)
+{
+  if (*s == '-')
+    s++;
+
+  if (*s == '0')
+    s++;
+  else if (isDigit(*s))
+    while (isDigit(*s))
+      s++;
+  else
+    return false;
+
+  if (*s == '.')
+  {
+    if (!isDigit(*++s))
+      return false;
+
+    while (isDigit(*s))
+      s++;
+  }
+
+  if (*s == 'e' || *s == 'E')
+  {
+    s++;
+
+    if (*s == '+' || *s == '-')
+      s++;
+
+    if (!isDigit(*s))
+      return false;
+
+    while (isDigit(*s))
+      s++;
+  }
+
+  return (*s == '\0');
+}
+
+/////////////////////////////////////////////////
+
+void AsyncJsonParser::reset()
+{
+  _state = JSON_STATE_VALUE;
+  _depth = 0;
+  _error = AWS_JSON_OK;
+  _key = false;
+  _done = false;
+  _hexDigits = 0;
+  _codePoint = 0;
+  _surrogate = 0;
+  _offset = 0;
+  _tokenLength = 0;
+  _pathLength = 0;
+  _token[0] = '\0';
+  _path[0] = '\0';
+}
+
+/////////////////////////////////////////////////
+
+bool AsyncJsonParser::parse(const uint8_t* data, size_t len, const AwsJsonValueHandler& onValue)
+{
+  if (_error != AWS_JSON_OK)
+    return false;
+
+  for (size_t i = 0; i < len; i++)
+  {
+    if (!_byte((char) data[i], onValue))
+      return false;
+
+    _offset++;
+  }
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+
+bool AsyncJsonParser::finish(const AwsJsonValueHandler& onValue)
+{
+  if (_error != AWS_JSON_OK)
+    return false;
+
+  // A number or literal at the root ends with the document
+  if (_depth == 0 && (_state == JSON_STATE_NUMBER || _state == JSON_STATE_LITERAL))
+  {
+    if (!_endToken(onValue))
+      return false;
+  }
+
+  if (!_done)
+    return _fail(AWS_JSON_ERROR_INCOMPLETE);
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+
+bool AsyncJsonParser::_fail(AwsJsonError error)
+{
+  _error = error;
+
+  return false;
+}
+
+/////////////////////////////////////////////////
+
+bool AsyncJsonParser::_byte(char c, const AwsJsonValueHandler& onValue)
+{
+  switch (_state)
+  {
+    case JSON_STATE_STRING:
+      if (_surrogate && c != '\\')
+      {
+        if (!_pushCodePoint(_surrogate))
+          return false;
+
+        _surrogate = 0;
+      }
+
+      if (c == '"')
+        return _endToken(onValue);
+
+      if (c == '\\')
+      {
+        _state = JSON_STATE_ESCAPE;
+
+        return true;
+      }
+
+      if ((uint8_t) c < 0x20)
+        return _fail(AWS_JSON_ERROR_SYNTAX);
+
+      return _pushToken(c);
+
+    case JSON_STATE_ESCAPE:
+      _state = JSON_STATE_STRING;
+
+      if (c == 'u')
+      {
+        _state = JSON_STATE_UNICODE;
+        _hexDigits = 0;
+        _codePoint = 0;
+
+        return true;
+      }
+
+      if (_surrogate)
+      {
+        if (!_pushCodePoint(_surrogate))
+          return false;
+
+        _surrogate = 0;
+      }
+
+      switch (c)
+      {
+        case '"':
+        case '\\':
+        case '/':
+          return _pushToken(c);
+
+        case 'b':
+          return _pushToken('\b');
+
+        case 'f':
+          return _pushToken('\f');
+
+        case 'n':
+          return _pushToken('\n');
+
+        case 'r':
+          return _pushToken('\r');
+
+        case 't':
+          return _pushToken('\t');
+
+        default:
+          return _fail(AWS_JSON_ERROR_SYNTAX);
+      }
+
+    case JSON_STATE_UNICODE:
+      if (isDigit(c))
+        _codePoint = (_codePoint << 4) | (c - '0');
+      else if (c >= 'a' && c <= 'f')
+        _codePoint = (_codePoint << 4) | (c - 'a' + 10);
+      else if (c >= 'A' && c <= 'F')
+        _codePoint = (_codePoint << 4) | (c - 'A' + 10);
+      else
+        return _fail(AWS_JSON_ERROR_SYNTAX);
+
+      if (++_hexDigits < 4)
+        return true;
+
+      _state = JSON_STATE_STRING;
+
+      if (_codePoint >= 0xDC00 && _codePoint <= 0xDFFF && _surrogate)
+      {
+        uint32_t codePoint = 0x10000 + (((uint32_t) _surrogate - 0xD800) << 10) + (_codePoint - 0xDC00);
+
+        _surrogate = 0;
+
+        return _pushCodePoint(codePoint);
+      }
+
+      // A lone surrogate is kept as is
+      if (_surrogate)
+      {
+        if (!_pushCodePoint(_surrogate))
+          return false;
+
+        _surrogate = 0;
+      }
+
+      if (_codePoint >= 0xD800 && _codePoint <= 0xDBFF)
+      {
+        _surrogate = _codePoint;
+
+        return true;
+      }
+
+      return _pushCodePoint(_codePoint);
+
+    case JSON_STATE_NUMBER:
+      if (isDigit(c) || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E')
+        return _pushToken(c);
+
+      // c ends the number, then is parsed in the next state
+      return _endToken(onValue) && _byte(c, onValue);
+
+    case JSON_STATE_LITERAL:
+      if (c >= 'a' && c <= 'z')
+        return _pushToken(c);
+
+      return _endToken(onValue) && _byte(c, onValue);
+
+    default:
+      break;
+  }
+
+  if (isJsonSpace(c))
+    return true;
+
+  switch (_state)
+  {
+    case JSON_STATE_ARRAY_FIRST:
+      if (c == ']')
+        return _close(c);
+
+    // fall through
+
+    case JSON_STATE_VALUE:
+      return _startValue(c, onValue);
+
+    case JSON_STATE_OBJECT_FIRST:
+      if (c == '}')
+        return _close(c);
+
+    // fall through
+
+    case JSON_STATE_KEY:
+      if (c != '"')
+        return _fail(AWS_JSON_ERROR_SYNTAX);
+
+      _key = true;
+      _tokenLength = 0;
+      _state = JSON_STATE_STRING;
+
+      return true;
+
+    case JSON_STATE_COLON:
+      if (c != ':')
+        return _fail(AWS_JSON_ERROR_SYNTAX);
+
+      _state = JSON_STATE_VALUE;
+
+      return true;
+
+    case JSON_STATE_AFTER:
+      if (c == ',')
+      {
+        if (_stack[_depth - 1].isArray)
+        {
+          _stack[_depth - 1].index++;
+          _state = JSON_STATE_VALUE;
+        }
+        else
+        {
+          _state = JSON_STATE_KEY;
+        }
+
+        return true;
+      }
+
+      if (c == ']' || c == '}')
+        return _close(c);
+
+      return _fail(AWS_JSON_ERROR_SYNTAX);
+
+    default:
+      // JSON_STATE_DONE : only spaces after the root value
+      return _fail(AWS_JSON_ERROR_SYNTAX);
+  }
+}
+
+/////////////////////////////////////////////////
+
+bool AsyncJsonParser::_startValue(char c, const AwsJsonValueHandler& onValue)
+{
+  if (_depth && _stack[_depth - 1].isArray)
+  {
+    char index[16];
+    int len = snprintf(index, sizeof(index), "[%lu]", (unsigned long) _stack[_depth - 1].index);
+
+    _truncatePath();
+
+    if (!_appendPath(index, len, false))
+      return false;
+  }
+
+  if (c == '{' || c == '[')
+  {
+    if (_depth == JSON_PARSER_MAX_DEPTH)
+      return _fail(AWS_JSON_ERROR_TOO_DEEP);
+
+    const bool isArray = (c == '[');
+
+    onValue(_path, isArray ? AWS_JSON_ARRAY : AWS_JSON_OBJECT, "");
+
+    _stack[_depth].isArray = isArray;
+    _stack[_depth].index = 0;
+    _stack[_depth].pathLength = _pathLength;
+    _depth++;
+    _state = isArray ? JSON_STATE_ARRAY_FIRST : JSON_STATE_OBJECT_FIRST;
+
+    return true;
+  }
+
+  _tokenLength = 0;
+
+  if (c == '"')
+  {
+    _key = false;
+    _state = JSON_STATE_STRING;
+
+    return true;
+  }
+
+  if (c == '-' || isDigit(c))
+    _state = JSON_STATE_NUMBER;
+  else if (c == 't' || c == 'f' || c == 'n')
+    _state = JSON_STATE_LITERAL;
+  else
+    return _fail(AWS_JSON_ERROR_SYNTAX);
+
+  return _pushToken(c);
+}
+
+/////////////////////////////////////////////////
+
+bool AsyncJsonParser::_endToken(const AwsJsonValueHandler& onValue)
+{
+  _token[_tokenLength] = '\0';
+
+  if (_state == JSON_STATE_STRING && _key)
+  {
+    _truncatePath();
+
+    if (!_appendPath(_token, _tokenLength, true))
+      return false;
+
+    _state = JSON_STATE_COLON;
+
+    return true;
+  }
+
+  if (_state == JSON_STATE_STRING)
+  {
+    onValue(_path, AWS_JSON_STRING, _token);
+  }
+  else if (_state == JSON_STATE_NUMBER)
+  {
+    if (!isJsonNumber(_token))
+      return _fail(AWS_JSON_ERROR_SYNTAX);
+
+    onValue(_path, AWS_JSON_NUMBER, _token);
+  }
+  else if (!strcmp(_token, "null"))
+  {
+    onValue(_path, AWS_JSON_NULL, _token);
+  }
+  else if (!strcmp(_token, "true") || !strcmp(_token, "false"))
+  {
+    onValue(_path, AWS_JSON_BOOL, _token);
+  }
+  else
+  {
+    return _fail(AWS_JSON_ERROR_SYNTAX);
+  }
+
+  return _endValue();
+}
+
+/////////////////////////////////////////////////
+
+bool AsyncJsonParser::_endValue()
+{
+  if (_depth == 0)
+  {
+    _done = true;
+    _state = JSON_STATE_DONE;
+  }
+  else
+  {
+    _state = JSON_STATE_AFTER;
+  }
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+
+bool AsyncJsonParser::_close(char c)
+{
+  if (_stack[_depth - 1].isArray != (c == ']'))
+    return _fail(AWS_JSON_ERROR_SYNTAX);
+
+  _depth--;
+
+  // Back to the path of the container
+  _pathLength = _stack[_depth].pathLength;
+  _path[_pathLength] = '\0';
+
+  return _endValue();
+}
+
+/////////////////////////////////////////////////
+
+bool AsyncJsonParser::_pushToken(char c)
+{
+  if (_tokenLength == JSON_PARSER_MAX_TOKEN)
+    return _fail(AWS_JSON_ERROR_TOKEN_TOO_LONG);
+
+  _token[_tokenLength++] = c;
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+
+// UTF-8
+bool AsyncJsonParser::_pushCodePoint(uint32_t codePoint)
+{
+  if (codePoint < 0x80)
+    return _pushToken((char) codePoint);
+
+  if (codePoint < 0x800)
+    return _pushToken((char) (0xC0 | (codePoint >> 6))) && _pushToken((char) (0x80 | (codePoint & 0x3F)));
+
+  if (codePoint < 0x10000)
+    return _pushToken((char) (0xE0 | (codePoint >> 12))) && _pushToken((char) (0x80 | ((codePoint >> 6) & 0x3F)))
+           && _pushToken((char) (0x80 | (codePoint & 0x3F)));
+
+  return _pushToken((char) (0xF0 | (codePoint >> 18))) && _pushToken((char) (0x80 | ((codePoint >> 12) & 0x3F)))
+         && _pushToken((char) (0x80 | ((codePoint >> 6) & 0x3F))) && _pushToken((char) (0x80 | (codePoint & 0x3F)));
+}
+
+/////////////////////////////////////////////////
+
+bool AsyncJsonParser::_appendPath(const char* component, size_t len, bool member)
+{
+  const bool dot = member && _pathLength;
+
+  if (_pathLength + dot + len > JSON_PARSER_MAX_PATH)
+    return _fail(AWS_JSON_ERROR_PATH_TOO_LONG);
+
+  if (dot)
+    _path[_pathLength++] = '.';
+
+  memcpy(_path + _pathLength, component, len);
+  _pathLength += len;
+  _path[_pathLength] = '\0';
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+
+// Path of the innermost container, before appending a member or element
+void AsyncJsonParser::_truncatePath()
+{
+  _pathLength = _depth ? _stack[_depth - 1].pathLength : 0;
+  _path[_pathLength] = '\0';
+}
+
+/////////////////////////////////////////////////
+
+}
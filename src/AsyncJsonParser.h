@@ -0,0 +1,189 @@
+/****************************************************************************************************************************
+  AsyncJsonParser.h - Dead simple Ethernet AsyncWebServer.
+
+  For LAN8720 Ethernet in WT32_ETH01 (ESP32 + LAN8720)
+
+  AsyncWebServer_WT32_ETH01 is a library for the Ethernet LAN8720 in WT32_ETH01 to run AsyncWebServer
+
+  Based on and modified from ESPAsyncWebServer (https://github.com/me-no-dev/ESPAsyncWebServer)
+  Built by Khoi Hoang https://github.com/khoih-prog/AsyncWebServer_WT32_ETH01
+  Licensed under GPLv3 license
+
+  Original author: Hristo Gochkov
+
+  Copyright (c) 2016 Hristo Gochkov. All rights reserved.
+
+  This library is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License along with this library;
+  if not, write to the Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+  Version: 1.6.2
+
+  Version Modified By   Date      Comments
+  ------- -----------  ---------- -----------
+  1.2.3   K Hoang      17/07/2021 Initial porting for WT32_ETH01 (ESP32 + LAN8720). Sync with ESPAsyncWebServer v1.2.3
+  1.2.4   K Hoang      02/08/2021 Fix Mbed TLS compile error with ESP32 core v2.0.0-rc1+
+  1.2.5   K Hoang      09/10/2021 Update `platform.ini` and `library.json`Working only with core v1.0.6-
+  1.3.0   K Hoang      23/10/2021 Making compatible with breaking core v2.0.0+
+  1.4.0   K Hoang      27/11/2021 Auto detect ESP32 core version
+  1.4.1   K Hoang      29/11/2021 Fix bug in examples to reduce connection time
+  1.5.0   K Hoang      01/10/2022 Fix AsyncWebSocket bug
+  1.6.0   K Hoang      04/10/2022 Option to use cString instead of String to save Heap
+  1.6.1   K Hoang      05/10/2022 Don't need memmove(), String no longer destroyed
+  1.6.2   K Hoang      10/11/2022 Add examples to demo how to use beginChunkedResponse() to send in chunks
+ *****************************************************************************************************************************/
+/*
+  Incremental (SAX style) JSON parser : the text is fed in chunks as it arrives, and each value is reported with
+  its path as soon as it is complete. Memory is fixed, whatever the size of the document : the longest string or
+  number, the path and the nesting depth are bounded by the macros below.
+
+  Paths use dots for members and brackets for array elements, e.g. "wifi.ssid", "servers[1].port". Objects and
+  arrays are reported when they open, with an empty value, so that a list can be reset before its elements.
+
+  The parser has no destructor to run and can live in malloc'd memory, e.g. request->_tempObject.
+
+  AsyncJsonParser parser;
+
+  parser.parse(data, len, [](const char* path, AwsJsonType type, const char* value)
+  {
+    if (!strcmp(path, "wifi.ssid"))
+      ...
+  });
+
+  bool valid = parser.finish(onValue);
+*/
+
+#ifndef ASYNC_JSON_PARSER_H_
+#define ASYNC_JSON_PARSER_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#include <functional>
+
+// Longest string or number, in bytes once unescaped
+#ifndef JSON_PARSER_MAX_TOKEN
+  #define JSON_PARSER_MAX_TOKEN       256
+#endif
+
+// Longest path, e.g. "servers[1].port"
+#ifndef JSON_PARSER_MAX_PATH
+  #define JSON_PARSER_MAX_PATH        128
+#endif
+
+// Nested objects and arrays
+#ifndef JSON_PARSER_MAX_DEPTH
+  #define JSON_PARSER_MAX_DEPTH       16
+#endif
+
+namespace eth {
+
+/////////////////////////////////////////////////
+
+typedef enum
+{
+  AWS_JSON_NULL,
+  AWS_JSON_BOOL,        // value "true" or "false"
+  AWS_JSON_NUMBER,      // value as in the text, for atoi() / atof()
+  AWS_JSON_STRING,      // value unescaped, UTF-8
+  AWS_JSON_OBJECT,      // opened, value ""
+  AWS_JSON_ARRAY        // opened, value ""
+} AwsJsonType;
+
+typedef enum
+{
+  AWS_JSON_OK,
+  AWS_JSON_ERROR_SYNTAX,
+  AWS_JSON_ERROR_TOKEN_TOO_LONG,
+  AWS_JSON_ERROR_PATH_TOO_LONG,
+  AWS_JSON_ERROR_TOO_DEEP,
+  AWS_JSON_ERROR_INCOMPLETE
+} AwsJsonError;
+
+typedef std::function<void(const char* path, AwsJsonType type, const char* value)> AwsJsonValueHandler;
+
+/////////////////////////////////////////////////
+
+/*
+   AsyncJsonParser :: Incremental JSON parser with path based callbacks
+ * */
+
+class AsyncJsonParser
+{
+  private:
+    uint8_t _state;
+    uint8_t _depth;
+    uint8_t _error;
+    bool _key;                  // String being read is a member name
+    bool _done;                 // Root value complete
+    uint8_t _hexDigits;         // Of a \u escape
+    uint16_t _codePoint;
+    uint16_t _surrogate;        // High surrogate waiting for its low half
+    size_t _offset;             // Of the next byte in the document
+    size_t _tokenLength;
+    size_t _pathLength;
+
+    struct
+    {
+      bool isArray;
+      uint32_t index;
+      uint16_t pathLength;      // Path of the container itself
+    } _stack[JSON_PARSER_MAX_DEPTH];
+
+    char _token[JSON_PARSER_MAX_TOKEN + 1];
+    char _path[JSON_PARSER_MAX_PATH + 1];
+
+    bool _fail(AwsJsonError error);
+    bool _byte(char c, const AwsJsonValueHandler& onValue);
+    bool _startValue(char c, const AwsJsonValueHandler& onValue);
+    bool _endValue();
+    bool _endToken(const AwsJsonValueHandler& onValue);
+    bool _close(char c);
+    bool _pushToken(char c);
+    bool _pushCodePoint(uint32_t codePoint);
+    bool _appendPath(const char* component, size_t len, bool member);
+    void _truncatePath();
+
+  public:
+    AsyncJsonParser()
+    {
+      reset();
+    }
+
+    /////////////////////////////////////////////////
+
+    void reset();
+
+    // Feed the next chunk of the document. Returns false, now and for the following chunks, on error.
+    bool parse(const uint8_t* data, size_t len, const AwsJsonValueHandler& onValue);
+
+    // End of the document : reports a number at the root. Returns true when one complete value was parsed.
+    bool finish(const AwsJsonValueHandler& onValue);
+
+    /////////////////////////////////////////////////
+
+    inline AwsJsonError error() const
+    {
+      return (AwsJsonError) _error;
+    }
+
+    /////////////////////////////////////////////////
+
+    // Offset in the document of the byte in error
+    inline size_t errorOffset() const
+    {
+      return _offset;
+    }
+};
+
+/////////////////////////////////////////////////
+
+}
+
+#endif    // ASYNC_JSON_PARSER_H_
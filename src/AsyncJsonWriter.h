@@ -0,0 +1,462 @@
+/****************************************************************************************************************************
+  AsyncJsonWriter.h - Dead simple Ethernet AsyncWebServer.
+
+  For LAN8720 Ethernet in WT32_ETH01 (ESP32 + LAN8720)
+
+  AsyncWebServer_WT32_ETH01 is a library for the Ethernet LAN8720 in WT32_ETH01 to run AsyncWebServer
+
+  Based on and modified from ESPAsyncWebServer (https://github.com/me-no-dev/ESPAsyncWebServer)
+  Built by Khoi Hoang https://github.com/khoih-prog/AsyncWebServer_WT32_ETH01
+  Licensed under GPLv3 license
+
+  Original author: Hristo Gochkov
+
+  Copyright (c) 2016 Hristo Gochkov. All rights reserved.
+
+  This library is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License along with this library;
+  if not, write to the Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+  Version: 1.6.2
+
+  Version Modified By   Date      Comments
+  ------- -----------  ---------- -----------
+  1.2.3   K Hoang      17/07/2021 Initial porting for WT32_ETH01 (ESP32 + LAN8720). Sync with ESPAsyncWebServer v1.2.3
+  1.2.4   K Hoang      02/08/2021 Fix Mbed TLS compile error with ESP32 core v2.0.0-rc1+
+  1.2.5   K Hoang      09/10/2021 Update `platform.ini` and `library.json`Working only with core v1.0.6-
+  1.3.0   K Hoang      23/10/2021 Making compatible with breaking core v2.0.0+
+  1.4.0   K Hoang      27/11/2021 Auto detect ESP32 core version
+  1.4.1   K Hoang      29/11/2021 Fix bug in examples to reduce connection time
+  1.5.0   K Hoang      01/10/2022 Fix AsyncWebSocket bug
+  1.6.0   K Hoang      04/10/2022 Option to use cString instead of String to save Heap
+  1.6.1   K Hoang      05/10/2022 Don't need memmove(), String no longer destroyed
+  1.6.2   K Hoang      10/11/2022 Add examples to demo how to use beginChunkedResponse() to send in chunks
+ *****************************************************************************************************************************/
+/*
+  Typed JSON writer, for responses of a fixed shape : the schema is a type, its longest JSON text is known at
+  compile time, and values are written straight to text, without a JsonDocument.
+
+  ASYNC_JSON_FIELD(Temp, "temp", float);
+  ASYNC_JSON_FIELD(Rh,   "rh",   float);
+  ASYNC_JSON_FIELD(Ts,   "ts",   uint32_t);
+
+  typedef AsyncJsonObject<Temp, Rh, Ts> Reading;     // {"temp":21.5,"rh":40.2,"ts":123456}
+
+  request->send(new AsyncTypedJsonResponse<Reading>(Reading(21.5, 40.2, millis())));
+
+  Field types : bool, integers, float, double, AsyncJsonString<N> (at most N bytes), AsyncJsonArray<T, N>
+  (at most N elements) and nested AsyncJsonObject<...>. Field names are written as is, without escaping.
+  Non finite floats are written as null.
+*/
+
+#ifndef ASYNC_JSON_WRITER_H_
+#define ASYNC_JSON_WRITER_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <cmath>
+#include <limits>
+#include <tuple>
+#include <type_traits>
+
+/////////////////////////////////////////////////
+
+// The type may hold commas, e.g. AsyncJsonArray<int, 4>
+#define ASYNC_JSON_FIELD(Name, key, ...)                  \
+  struct Name                                             \
+  {                                                       \
+    typedef __VA_ARGS__ type;                             \
+    static constexpr const char* name() { return key; }   \
+  }
+
+namespace eth {
+
+/////////////////////////////////////////////////
+
+constexpr size_t jsonLiteralLength(const char* s)
+{
+  return *s ? 1 + jsonLiteralLength(s + 1) : 0;
+}
+
+/////////////////////////////////////////////////
+
+// Writer of a type : maxLength, the longest text, and write(out, value), which returns the length written.
+// Not defined for unsupported types.
+template<typename T, typename Enable = void>
+struct AsyncJsonWriter;
+
+/////////////////////////////////////////////////
+
+template<>
+struct AsyncJsonWriter<bool>
+{
+  static constexpr size_t maxLength = 5;
+
+  static size_t write(char* out, bool value)
+  {
+    if (value)
+    {
+      memcpy(out, "true", 4);
+
+      return 4;
+    }
+
+    memcpy(out, "false", 5);
+
+    return 5;
+  }
+};
+
+/////////////////////////////////////////////////
+
+template<typename T>
+struct AsyncJsonWriter<T, typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value>::type>
+{
+  static constexpr size_t maxLength = std::numeric_limits<T>::digits10 + 1 + std::is_signed<T>::value;
+
+  static size_t write(char* out, T value)
+  {
+    typedef typename std::make_unsigned<T>::type Unsigned;
+
+    char digits[std::numeric_limits<Unsigned>::digits10 + 1];
+    Unsigned magnitude = (Unsigned) value;
+    size_t count = 0;
+    size_t len = 0;
+
+    if (value < 0)
+    {
+      out[len++] = '-';
+      magnitude = (Unsigned) 0 - magnitude;
+    }
+
+    do
+    {
+      digits[count++] = '0' + (magnitude % 10);
+      magnitude /= 10;
+    } while (magnitude);
+
+    while (count)
+      out[len++] = digits[--count];
+
+    return len;
+  }
+};
+
+/////////////////////////////////////////////////
+
+// digits10 significant digits, as "%g" : float 6, double 15
+template<typename T>
+struct AsyncJsonWriter<T, typename std::enable_if<std::is_floating_point<T>::value>::type>
+{
+  // Sign, point and exponent "e-308"
+  static constexpr size_t maxLength = std::numeric_limits<T>::digits10 + 2 + 5;
+
+  static size_t write(char* out, T value)
+  {
+    if (!std::isfinite(value))
+    {
+      memcpy(out, "null", 4);
+
+      return 4;
+    }
+
+    // out has room for the NUL
+    return snprintf(out, maxLength + 1, "%.*g", std::numeric_limits<T>::digits10, (double) value);
+  }
+};
+
+/////////////////////////////////////////////////
+
+template<size_t N>
+class AsyncJsonString
+{
+  private:
+    char _value[N + 1];
+
+  public:
+    AsyncJsonString(const char* value = "")
+    {
+      set(value);
+    }
+
+    /////////////////////////////////////////////////
+
+    // Cut to N bytes, on a UTF-8 character boundary
+    void set(const char* value)
+    {
+      size_t len = strnlen(value, N + 1);
+
+      if (len > N)
+      {
+        len = N;
+
+        while (len && ((uint8_t) value[len] & 0xC0) == 0x80)
+          len--;
+      }
+
+      memcpy(_value, value, len);
+      _value[len] = '\0';
+    }
+
+    /////////////////////////////////////////////////
+
+    inline const char* c_str() const
+    {
+      return _value;
+    }
+};
+
+/////////////////////////////////////////////////
+
+template<size_t N>
+struct AsyncJsonWriter<AsyncJsonString<N>>
+{
+  // Quotes, and each byte escaped as \u00XX at worst
+  static constexpr size_t maxLength = 2 + 6 * N;
+
+  static size_t write(char* out, const AsyncJsonString<N>& value)
+  {
+    static const char hex[] = "0123456789abcdef";
+    size_t len = 0;
+
+    out[len++] = '"';
+
+    for (const char* s = value.c_str(); *s; s++)
+    {
+      const uint8_t c = (uint8_t) *s;
+
+      if (c == '"' || c == '\\')
+      {
+        out[len++] = '\\';
+        out[len++] = c;
+      }
+      else if (c == '\n')
+      {
+        out[len++] = '\\';
+        out[len++] = 'n';
+      }
+      else if (c < 0x20)
+      {
+        memcpy(out + len, "\\u00", 4);
+        out[len + 4] = hex[c >> 4];
+        out[len + 5] = hex[c & 0x0F];
+        len += 6;
+      }
+      else
+      {
+        out[len++] = c;
+      }
+    }
+
+    out[len++] = '"';
+
+    return len;
+  }
+};
+
+/////////////////////////////////////////////////
+
+template<typename T, size_t N>
+class AsyncJsonArray
+{
+  private:
+    T _values[N];
+    size_t _count;
+
+  public:
+    AsyncJsonArray() : _count(0) {}
+
+    /////////////////////////////////////////////////
+
+    // false when already full
+    bool add(const T& value)
+    {
+      if (_count == N)
+        return false;
+
+      _values[_count++] = value;
+
+      return true;
+    }
+
+    /////////////////////////////////////////////////
+
+    inline size_t size() const
+    {
+      return _count;
+    }
+
+    /////////////////////////////////////////////////
+
+    inline const T& operator[](size_t index) const
+    {
+      return _values[index];
+    }
+
+    /////////////////////////////////////////////////
+
+    inline void clear()
+    {
+      _count = 0;
+    }
+};
+
+/////////////////////////////////////////////////
+
+template<typename T, size_t N>
+struct AsyncJsonWriter<AsyncJsonArray<T, N>>
+{
+  static constexpr size_t maxLength = 2 + N * AsyncJsonWriter<T>::maxLength + (N ? N - 1 : 0);
+
+  static size_t write(char* out, const AsyncJsonArray<T, N>& value)
+  {
+    size_t len = 0;
+
+    out[len++] = '[';
+
+    for (size_t i = 0; i < value.size(); i++)
+    {
+      if (i)
+        out[len++] = ',';
+
+      len += AsyncJsonWriter<T>::write(out + len, value[i]);
+    }
+
+    out[len++] = ']';
+
+    return len;
+  }
+};
+
+/////////////////////////////////////////////////
+
+// Position of field F in Fields
+template<typename F, typename... Fields>
+struct AsyncJsonFieldIndex;
+
+template<typename F, typename... Rest>
+struct AsyncJsonFieldIndex<F, F, Rest...>
+{
+  static constexpr size_t value = 0;
+};
+
+template<typename F, typename G, typename... Rest>
+struct AsyncJsonFieldIndex<F, G, Rest...>
+{
+  static constexpr size_t value = 1 + AsyncJsonFieldIndex<F, Rest...>::value;
+};
+
+/////////////////////////////////////////////////
+
+template<typename... Fields>
+class AsyncJsonObject
+{
+    static_assert(sizeof...(Fields) > 0, "AsyncJsonObject needs at least one field");
+
+  public:
+    typedef std::tuple<typename Fields::type...> Values;
+
+    Values values;
+
+    /////////////////////////////////////////////////
+
+    AsyncJsonObject() : values() {}
+
+    // Values of all fields, in order
+    AsyncJsonObject(const typename Fields::type&... fieldValues) : values(fieldValues...) {}
+
+    /////////////////////////////////////////////////
+
+    // e.g. reading.get<Temp>() = 21.5;
+    template<typename F>
+    inline typename F::type& get()
+    {
+      return std::get<AsyncJsonFieldIndex<F, Fields...>::value>(values);
+    }
+
+    /////////////////////////////////////////////////
+
+    template<typename F>
+    inline const typename F::type& get() const
+    {
+      return std::get<AsyncJsonFieldIndex<F, Fields...>::value>(values);
+    }
+};
+
+/////////////////////////////////////////////////
+
+// "name":value for fields I and following, comma separated
+template<size_t I, typename... Fields>
+struct AsyncJsonFieldsWriter;
+
+template<size_t I>
+struct AsyncJsonFieldsWriter<I>
+{
+  static constexpr size_t maxLength = 0;
+
+  template<typename Values>
+  static size_t write(char* out __attribute__((unused)), const Values& values __attribute__((unused)))
+  {
+    return 0;
+  }
+};
+
+template<size_t I, typename F, typename... Rest>
+struct AsyncJsonFieldsWriter<I, F, Rest...>
+{
+  static constexpr size_t maxLength = (I ? 1 : 0) + 3 + jsonLiteralLength(F::name())
+                                      + AsyncJsonWriter<typename F::type>::maxLength
+                                      + AsyncJsonFieldsWriter < I + 1, Rest... >::maxLength;
+
+  template<typename Values>
+  static size_t write(char* out, const Values& values)
+  {
+    const size_t nameLength = jsonLiteralLength(F::name());
+    size_t len = 0;
+
+    if (I)
+      out[len++] = ',';
+
+    out[len++] = '"';
+    memcpy(out + len, F::name(), nameLength);
+    len += nameLength;
+    out[len++] = '"';
+    out[len++] = ':';
+
+    len += AsyncJsonWriter<typename F::type>::write(out + len, std::get<I>(values));
+
+    return len + AsyncJsonFieldsWriter < I + 1, Rest... >::write(out + len, values);
+  }
+};
+
+/////////////////////////////////////////////////
+
+template<typename... Fields>
+struct AsyncJsonWriter<AsyncJsonObject<Fields...>>
+{
+  static constexpr size_t maxLength = 2 + AsyncJsonFieldsWriter<0, Fields...>::maxLength;
+
+  static size_t write(char* out, const AsyncJsonObject<Fields...>& value)
+  {
+    size_t len = 0;
+
+    out[len++] = '{';
+    len += AsyncJsonFieldsWriter<0, Fields...>::write(out + len, value.values);
+    out[len++] = '}';
+
+    return len;
+  }
+};
+
+/////////////////////////////////////////////////
+
+}
+
+#endif    // ASYNC_JSON_WRITER_H_
@@ -93,6 +93,7 @@
 #include "FS.h"
 
 #include "StringArray.h"
+#include "WebCompression.h"
 
 //////////////////////////////////////////////////////////////
 // WT32_ETH01 related code
@@ -185,6 +186,8 @@ class AsyncWebHandler;
 class AsyncStaticWebHandler;
 class AsyncCallbackWebHandler;
 class AsyncResponseStream;
+class AsyncScatterGatherResponse;
+class AsyncDeferredResponse;
 
 /////////////////////////////////////////////////
 
@@ -346,6 +349,20 @@ typedef enum
 } RequestedConnectionType;
 
 typedef std::function<size_t(uint8_t*, size_t, size_t)> AwsResponseFiller;
+
+// Memory handed to the TCP stack without copy : must stay valid and unchanged until released
+typedef struct
+{
+  const uint8_t* data;
+  size_t len;
+} AwsResponseSpan;
+
+// (maxLen, index) : next span of the content from index on, {nullptr, 0} to fail, {nullptr, RESPONSE_TRY_AGAIN} to retry
+typedef std::function<AwsResponseSpan(size_t, size_t)> AwsResponseSpanFiller;
+// Span returned by the filler, once acknowledged by the client or once the connection is aborted or reset.
+// Never called for a span still unacked when the connection is closed gracefully (e.g. by the peer first),
+// as the TCP stack may still retransmit it after the response is gone
+typedef std::function<void(const uint8_t*, size_t)> AwsResponseSpanRelease;
 typedef std::function<String(const String&)> AwsTemplateProcessor;
 
 /////////////////////////////////////////////////
@@ -362,6 +379,7 @@ class AsyncWebServerRequest
     AsyncWebServer* _server;
     AsyncWebHandler* _handler;
     AsyncWebServerResponse* _response;
+    AsyncDeferredResponse* _deferred;
     StringArray _interestingHeaders;
     ArDisconnectHandler _onDisconnectfn;
 
@@ -401,6 +419,7 @@ class AsyncWebServerRequest
     bool _itemIsFile;
 
     void _onPoll();
+    void _pollDeferred();
     void _onAck(size_t len, uint32_t time);
     void _onError(int8_t error);
     void _onTimeout(uint32_t time);
@@ -523,6 +542,10 @@ class AsyncWebServerRequest
     void redirect(const String& url);
 
     void send(AsyncWebServerResponse *response);
+
+    // Detaches the request from the handler : the response is given later, from any task, through the handle.
+    // nullptr if a response was already sent or deferred
+    AsyncDeferredResponse *defer();
     void send(int code, const String& contentType = String(), const String& content = String());
 
     void send(int code, const String& contentType, const char *content, bool nonDetructiveSend = true);    // RSMOD
@@ -566,6 +589,9 @@ class AsyncWebServerRequest
     AsyncWebServerResponse *beginChunkedResponse(const String& contentType, AwsResponseFiller callback,
                                                  AwsTemplateProcessor templateCallback = nullptr);
     AsyncResponseStream *beginResponseStream(const String& contentType, size_t bufferSize = 1460);
+    AsyncScatterGatherResponse *beginScatterGatherResponse(int code, const String& contentType = String());
+    AsyncScatterGatherResponse *beginSpanResponse(const String& contentType, size_t len, AwsResponseSpanFiller filler,
+                                                  AwsResponseSpanRelease release = nullptr);
 
     AsyncWebServerResponse *beginResponse_P(int code, const String& contentType, const uint8_t * content, size_t len,
                                             AwsTemplateProcessor callback = nullptr);
@@ -610,6 +636,7 @@ class AsyncWebServerRequest
     const String& header(const __FlashStringHelper * data) const;// get request header value by F(name)
     const String& header(size_t i) const;        // get request header value by number
     const String& headerName(size_t i) const;    // get request header name by number
+    bool acceptsEncoding(const String& encoding) const;  // check Accept-Encoding, honouring q=0
     String urlDecode(const String& text) const;
 };
 
@@ -769,6 +796,15 @@ class AsyncWebHandler
     {
       return true;
     }
+
+    /////////////////////////////////////////////////
+
+    // Every response sent for a request attached to this handler goes through here first
+    virtual AsyncWebServerResponse* _beforeSend(AsyncWebServerRequest *request __attribute__((unused)),
+                                                AsyncWebServerResponse *response)
+    {
+      return response;
+    }
 };
 
 /////////////////////////////////////////////////
@@ -812,6 +848,18 @@ class AsyncWebServerResponse
     virtual void setContentLength(size_t len);
     virtual void setContentType(const String& type);
     virtual void addHeader(const String& name, const String& value);
+
+    inline int code() const
+    {
+      return _code;
+    }
+
+    // Opt-in streaming gzip / deflate of the body, only if the client accepts it.
+    // Ignored by responses sent in one piece (AsyncBasicResponse)
+    virtual void setCompression(size_t windowSize __attribute__((unused)) = DEFLATE_WINDOW_SIZE) {}
+
+    bool hasHeader(const String& name) const;
+    AsyncWebHeader* getHeader(const String& name) const;
     virtual String _assembleHead(uint8_t version);
     virtual bool _started() const;
     virtual bool _finished() const;
@@ -819,6 +867,61 @@ class AsyncWebServerResponse
     virtual bool _sourceValid() const;
     virtual void _respond(AsyncWebServerRequest *request);
     virtual size_t _ack(AsyncWebServerRequest *request, size_t len, uint32_t time);
+
+    // Whole response, head and body, as it would be sent. false, with the response left to be sent as usual,
+    // if the body can't be produced ahead of time or is longer than maxLength
+    virtual bool _render(uint8_t version __attribute__((unused)), String& out __attribute__((unused)),
+                         size_t maxLength __attribute__((unused)))
+    {
+      return false;
+    }
+
+    // true while the TCP stack references body data the response would release before its ack :
+    // the connection is then aborted rather than closed, see AsyncScatterGatherResponse
+    virtual bool _unackedByReference() const
+    {
+      return false;
+    }
+
+    // The connection was aborted or reset : the TCP stack dropped all it was still holding
+    virtual void _connectionAborted() {}
+};
+
+/////////////////////////////////////////////////
+
+/*
+   DEFERRED RESPONSE :: Handle to complete a request from another task (see AsyncWebServerRequest::defer)
+
+   The worker calls send() exactly once, then must not use the handle anymore. The response is picked up and
+   sent by the AsyncTCP task on its next poll of the connection (about every 500 ms). If the client disconnects
+   first, the handle is cancelled and the response given to send() is deleted.
+ * */
+
+class AsyncDeferredResponse
+{
+    friend class AsyncWebServerRequest;
+
+  private:
+    mutable portMUX_TYPE _lock;
+    uint8_t _refs;                        // The request and the worker
+    bool _cancelled;
+    bool _sent;                           // send() called, the worker's reference is gone
+    AsyncWebServerResponse* _response;
+
+    AsyncDeferredResponse();
+    ~AsyncDeferredResponse();
+
+    AsyncWebServerResponse* _take();
+    void _cancel();
+    void _release();
+
+  public:
+    // Disconnected client : the worker can give up early, but must still call send()
+    bool cancelled() const;
+
+    // false if cancelled or already sent, the response is then deleted. nullptr answers 500
+    bool send(AsyncWebServerResponse *response);
+    bool send(int code, const String& contentType = String(), const String& content = String());
 };
 
 /////////////////////////////////////////////////
@@ -70,7 +70,78 @@ size_t webSocketSendFrameWindow(AsyncClient *client)
 
 /////////////////////////////////////////////////
 
-size_t webSocketSendFrame(AsyncClient *client, bool final, uint8_t opcode, bool mask, uint8_t *data, size_t len)
+size_t webSocketFrameHeader(uint8_t *buf, bool final, uint8_t opcode, const uint8_t *mask, size_t len)
+{
+  size_t headLen = 2;
+
+  buf[0] = opcode & (WS_RSV1 | 0x0F);
+
+  if (final)
+    buf[0] |= 0x80;
+
+  if (len < 126)
+  {
+    buf[1] = len & 0x7F;
+  }
+  else if (len <= 0xFFFF)
+  {
+    buf[1] = 126;
+    buf[2] = (uint8_t)((len >> 8) & 0xFF);
+    buf[3] = (uint8_t)(len & 0xFF);
+    headLen += 2;
+  }
+  else
+  {
+    buf[1] = 127;
+
+    for (int i = 0; i < 8; i++)
+      buf[2 + i] = (uint8_t)(((uint64_t) len >> (8 * (7 - i))) & 0xFF);
+
+    headLen += 8;
+  }
+
+  if (mask)
+  {
+    buf[1] |= 0x80;
+    memcpy(buf + headLen, mask, 4);
+    headLen += 4;
+  }
+
+  return headLen;
+}
+
+/////////////////////////////////////////////////
+
+// Length of the encoded frame at frame, header included
+static size_t webSocketFrameLength(const uint8_t *frame)
+{
+  size_t headLen = 2;
+  uint64_t len = frame[1] & 0x7F;
+
+  if (len == 126)
+  {
+    len = (frame[2] << 8) | frame[3];
+    headLen += 2;
+  }
+  else if (len == 127)
+  {
+    len = 0;
+
+    for (int i = 0; i < 8; i++)
+      len = (len << 8) | frame[2 + i];
+
+    headLen += 8;
+  }
+
+  if (frame[1] & 0x80)
+    headLen += 4;
+
+  return headLen + (size_t) len;
+}
+
+/////////////////////////////////////////////////
+
+size_t webSocketAddFrame(AsyncClient *client, bool final, uint8_t opcode, bool mask, uint8_t *data, size_t len)
 {
   if (!client->canSend())
     return 0;
@@ -81,7 +152,7 @@ size_t webSocketSendFrame(AsyncClient *client, bool final, uint8_t opcode, bool
     return 0;
 
   uint8_t mbuf[4] = {0, 0, 0, 0};
-  uint8_t headLen = 2;
+  size_t headLen = 2;
 
   if (len && mask)
   {
@@ -103,68 +174,157 @@ size_t webSocketSendFrame(AsyncClient *client, bool final, uint8_t opcode, bool
   if (len > space)
     len = space;
 
-  uint8_t *buf = (uint8_t*)malloc(headLen);
+  // Header, and small payloads, on the stack : one add() for the whole frame
+  uint8_t buf[WS_MAX_HEADER_SIZE + WS_SMALL_FRAME_SIZE];
 
-  if (buf == NULL)
+  headLen = webSocketFrameHeader(buf, final, opcode, (len && mask) ? mbuf : NULL, len);
+
+  if (len <= WS_SMALL_FRAME_SIZE)
   {
-    AWS_LOGDEBUG1(F("Error malloc for frame header (bytes):"), headLen);
-    return 0;
+    if (len)
+    {
+      memcpy(buf + headLen, data, len);
+
+      if (mask)
+        webSocketMask(buf + headLen, len, mbuf, 0);
+    }
+
+    if (client->add((const char *)buf, headLen + len) != headLen + len)
+    {
+      AWS_LOGDEBUG1(F("Error adding frame (bytes):"), headLen + len);
+
+      return 0;
+    }
+
+    return len;
   }
 
-  buf[0] = opcode & 0x0F;
+  if (client->add((const char *)buf, headLen, ASYNC_WRITE_FLAG_COPY | ASYNC_WRITE_FLAG_MORE) != headLen)
+  {
+    AWS_LOGDEBUG1(F("Error adding header (bytes):"), headLen);
 
-  if (final)
-    buf[0] |= 0x80;
+    return 0;
+  }
 
-  if (len < 126)
-    buf[1] = len & 0x7F;
-  else
+  if (mask)
   {
-    buf[1] = 126;
-    buf[2] = (uint8_t)((len >> 8) & 0xFF);
-    buf[3] = (uint8_t)(len & 0xFF);
+    webSocketMask(data, len, mbuf, 0);
   }
 
-  if (len && mask)
+  if (client->add((const char *)data, len) != len)
   {
-    buf[1] |= 0x80;
-    memcpy(buf + (headLen - 4), mbuf, 4);
+    AWS_LOGDEBUG1(F("Error adding data (bytes):"), len);
+
+    return 0;
   }
 
-  if (client->add((const char *)buf, headLen) != headLen)
+  return len;
+}
+
+/////////////////////////////////////////////////
+
+size_t webSocketSendFrame(AsyncClient *client, bool final, uint8_t opcode, bool mask, uint8_t *data, size_t len)
+{
+  if (!client->canSend() || client->space() < 2)
+    return 0;
+
+  len = webSocketAddFrame(client, final, opcode, mask, data, len);
+
+  if (!client->send())
   {
-    AWS_LOGDEBUG1(F("Error adding header (bytes):"), headLen);
-    free(buf);
+    AWS_LOGDEBUG1(F("Error sending frame (bytes):"), len);
 
     return 0;
   }
 
-  free(buf);
+  return len;
+}
 
-  if (len)
+/////////////////////////////////////////////////
+
+// Compress a whole message and end it with a sync flush, whose 00 00 FF FF is left out (RFC 7692 7.2.1).
+// Returns a malloc'd buffer, NULL without memory
+static uint8_t * webSocketDeflate(AsyncDeflater * deflater, const uint8_t * data, size_t len, size_t & outLen,
+                                  bool progmem = false)
+{
+  size_t capacity = (len >> 2) + 64;
+  uint8_t * out = (uint8_t *) malloc(capacity);
+  size_t done = 0;
+  bool flushed = false;
+
+  outLen = 0;
+
+  while (out)
   {
-    if (len && mask)
+    if (deflater->pending())
     {
-      size_t i;
+      if (outLen == capacity)
+      {
+        uint8_t * grown = (uint8_t *) realloc(out, capacity << 1);
+
+        if (!grown)
+        {
+          free(out);
+          out = NULL;
+
+          break;
+        }
+
+        out = grown;
+        capacity <<= 1;
+      }
+
+      outLen += deflater->read(out + outLen, capacity - outLen);
 
-      for (i = 0; i < len; i++)
-        data[i] = data[i] ^ mbuf[i % 4];
+      continue;
     }
 
-    if (client->add((const char *)data, len) != len)
+    if (flushed)
+      break;
+
+    if (done == len)
     {
-      AWS_LOGDEBUG1(F("Error adding data (bytes):"), len);
-      return 0;
+      deflater->flush();
+      flushed = true;
+
+      continue;
+    }
+
+    size_t space;
+    uint8_t * input = deflater->inputBuffer(space);
+
+    if (!input)
+    {
+      free(out);
+      out = NULL;
+
+      break;
     }
+
+    if (space > len - done)
+      space = len - done;
+
+    if (progmem)
+      memcpy_P(input, data + done, space);
+    else
+      memcpy(input, data + done, space);
+
+    deflater->commit(space);
+    done += space;
   }
 
-  if (!client->send())
+  if (!out || outLen < 4)
   {
-    AWS_LOGDEBUG1(F("Error sending frame (bytes):"), headLen + len);
-    return 0;
+    AWS_LOGDEBUG1(F("webSocketDeflate: failed, len ="), len);
+
+    free(out);
+
+    return NULL;
   }
 
-  return len;
+  outLen -= 4;
+
+  return out;
 }
 
 /////////////////////////////////////////////////
@@ -493,6 +653,48 @@ size_t AsyncWebSocketBasicMessage::send(AsyncClient *client)
 
 /////////////////////////////////////////////////
 
+bool AsyncWebSocketBasicMessage::addComplete(AsyncClient *client, size_t window)
+{
+  // _ack counts the header too : not 0 once anything, even an empty frame, is sent
+  if (_status != WS_MSG_SENDING || _ack || _len > window)
+    return false;
+
+  if (webSocketAddFrame(client, true, _opcode, _mask, _data, _len) != _len)
+    return false;
+
+  _sent = _len;
+  _ack = _len + ((_len < 126) ? 2 : 4) + (_mask * 4);
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+
+bool AsyncWebSocketBasicMessage::deflate(AsyncDeflater *deflater, bool force)
+{
+  size_t len;
+  uint8_t * data = webSocketDeflate(deflater, _data, _len, len);
+
+  if (!data)
+    return false;
+
+  if (!force && len >= _len)
+  {
+    free(data);
+
+    return false;
+  }
+
+  free(_data);
+  _data = data;
+  _len = len;
+  _opcode |= WS_RSV1;
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+
 // bool AsyncWebSocketBasicMessage::reserve(size_t size)
 //{
 //   if (size) {
@@ -520,6 +722,7 @@ AsyncWebSocketMultiMessage::AsyncWebSocketMultiMessage(AsyncWebSocketMessageBuff
   , _ack(0)
   , _acked(0)
   , _WSbuffer(nullptr)
+  , _deflated(nullptr)
 {
 
   _opcode = opcode & 0x07;
@@ -550,6 +753,57 @@ AsyncWebSocketMultiMessage::~AsyncWebSocketMultiMessage()
   {
     (*_WSbuffer)--; // decreases the counter.
   }
+
+  free(_deflated);
+}
+
+/////////////////////////////////////////////////
+
+bool AsyncWebSocketMultiMessage::addComplete(AsyncClient *client, size_t window)
+{
+  // _ack counts the header too : not 0 once anything, even an empty frame, is sent
+  if (_status != WS_MSG_SENDING || _ack || _len > window)
+    return false;
+
+  if (webSocketAddFrame(client, true, _opcode, _mask, _data, _len) != _len)
+    return false;
+
+  _sent = _len;
+  _ack = _len + ((_len < 126) ? 2 : 4) + (_mask * 4);
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+
+// The shared buffer is released, the message then sends its own compressed copy
+bool AsyncWebSocketMultiMessage::deflate(AsyncDeflater *deflater, bool force)
+{
+  size_t len;
+  uint8_t * data = webSocketDeflate(deflater, _data, _len, len);
+
+  if (!data)
+    return false;
+
+  if (!force && len >= _len)
+  {
+    free(data);
+
+    return false;
+  }
+
+  if (_WSbuffer)
+  {
+    (*_WSbuffer)--;
+    _WSbuffer = nullptr;
+  }
+
+  _deflated = data;
+  _data = data;
+  _len = len;
+  _opcode |= WS_RSV1;
+
+  return true;
 }
 
 /////////////////////////////////////////////////
@@ -633,112 +887,436 @@ size_t AsyncWebSocketMultiMessage::send(AsyncClient *client)
 /////////////////////////////////////////////////
 
 /*
-   Async WebSocket Client
+   AsyncWebSocketBatchMessage Message
 */
-const char * AWSC_PING_PAYLOAD = "AsyncWebServer_WT32-PING";
-const size_t AWSC_PING_PAYLOAD_LEN = 22;
-
-/////////////////////////////////////////////////
 
-AsyncWebSocketClient::AsyncWebSocketClient(AsyncWebServerRequest *request, AsyncWebSocket *server)
-  : _controlQueue(LinkedList<AsyncWebSocketControl * >([](AsyncWebSocketControl * c)
-{
-  delete  c;
-}))
-, _messageQueue(LinkedList<AsyncWebSocketMessage *>([](AsyncWebSocketMessage *m)
-{
-  delete  m;
-}))
-, _tempObject(NULL)
+AsyncWebSocketBatchMessage::AsyncWebSocketBatchMessage(size_t reserve, bool mask)
+  : _data(NULL)
+  , _len(0)
+  , _capacity(0)
+  , _sent(0)
+  , _frameEnd(0)
+  , _ack(0)
+  , _acked(0)
 {
-  _client = request->client();
-  _server = server;
-  _clientId = _server->_getNextId();
-  _status = WS_CONNECTED;
-  _pstate = 0;
-  _lastMessageTime = millis();
-  _keepAlivePeriod = 0;
-  _client->setRxTimeout(0);
-
-  _client->onError([](void *r, AsyncClient * c, int8_t error)
-  {
-    WT32_ETH01_AWS_UNUSED(c);
-    ((AsyncWebSocketClient*)(r))->_onError(error);
-  }, this);
-
-  _client->onAck([](void *r, AsyncClient * c, size_t len, uint32_t time)
-  {
-    WT32_ETH01_AWS_UNUSED(c);
-    ((AsyncWebSocketClient*)(r))->_onAck(len, time);
-  }, this);
-
-  _client->onDisconnect([](void *r, AsyncClient * c)
-  {
-    ((AsyncWebSocketClient*)(r))->_onDisconnect();
-    delete c;
-  }, this);
-
-  _client->onTimeout([](void *r, AsyncClient * c, uint32_t time)
-  {
-    WT32_ETH01_AWS_UNUSED(c);
-    ((AsyncWebSocketClient*)(r))->_onTimeout(time);
-  }, this);
-
-  _client->onData([](void *r, AsyncClient * c, void *buf, size_t len)
-  {
-    WT32_ETH01_AWS_UNUSED(c);
-    ((AsyncWebSocketClient*)(r))->_onData(buf, len);
-  }, this);
+  _opcode = WS_TEXT;
+  _mask = mask;
+  _status = WS_MSG_SENDING;
 
-  _client->onPoll([](void *r, AsyncClient * c)
+  if (reserve)
   {
-    WT32_ETH01_AWS_UNUSED(c);
-    ((AsyncWebSocketClient*)(r))->_onPoll();
-  }, this);
+    _data = (uint8_t*)malloc(reserve);
 
-  _server->_addClient(this);
-  _server->_handleEvent(this, WS_EVT_CONNECT, request, NULL, 0);
-  delete request;
+    if (_data)
+      _capacity = reserve;
+  }
 }
 
 /////////////////////////////////////////////////
 
-AsyncWebSocketClient::~AsyncWebSocketClient()
+AsyncWebSocketBatchMessage::~AsyncWebSocketBatchMessage()
 {
-  _messageQueue.free();
-  _controlQueue.free();
-  _server->_handleEvent(this, WS_EVT_DISCONNECT, NULL, NULL, 0);
+  if (_data != NULL)
+    free(_data);
 }
 
 /////////////////////////////////////////////////
 
-void AsyncWebSocketClient::_onAck(size_t len, uint32_t time)
+bool AsyncWebSocketBatchMessage::add(uint8_t opcode, const uint8_t * data, size_t len)
 {
-  _lastMessageTime = millis();
+  // Frames already on their way can't move
+  if (_sent)
+    return false;
 
-  if (!_controlQueue.isEmpty())
+  const size_t needed = _len + WS_MAX_HEADER_SIZE + len;
+
+  if (needed > _capacity)
   {
-    auto head = _controlQueue.front();
+    const size_t capacity = (needed > 2 * _capacity) ? needed : 2 * _capacity;
+    uint8_t * grown = (uint8_t*)realloc(_data, capacity);
 
-    if (head->finished())
+    if (grown == NULL)
     {
-      len -= head->len();
+      AWS_LOGDEBUG1(F("AsyncWebSocketBatchMessage: no memory for (bytes):"), capacity);
 
-      if (_status == WS_DISCONNECTING && head->opcode() == WS_DISCONNECT)
+      return false;
+    }
+
+    _data = grown;
+    _capacity = capacity;
+  }
+
+  uint8_t mbuf[4];
+
+  if (len && _mask)
+  {
+    mbuf[0] = rand() % 0xFF;
+    mbuf[1] = rand() % 0xFF;
+    mbuf[2] = rand() % 0xFF;
+    mbuf[3] = rand() % 0xFF;
+  }
+
+  _len += webSocketFrameHeader(_data + _len, true, opcode, (len && _mask) ? mbuf : NULL, len);
+
+  if (len)
+  {
+    memcpy(_data + _len, data, len);
+
+    if (_mask)
+      webSocketMask(_data + _len, len, mbuf, 0);
+
+    _len += len;
+  }
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+
+void AsyncWebSocketBatchMessage::ack(size_t len, uint32_t time)
+{
+  WT32_ETH01_AWS_UNUSED(time);
+
+  _acked += len;
+
+  if (_sent == _len && _acked == _ack)
+  {
+    _status = WS_MSG_SENT;
+  }
+}
+
+/////////////////////////////////////////////////
+
+bool AsyncWebSocketBatchMessage::addComplete(AsyncClient *client, size_t window)
+{
+  const size_t len = _len;
+
+  if (_status != WS_MSG_SENDING || _sent || !len || len > window)
+    return false;
+
+  if (client->add((const char *) _data, len) != len)
+    return false;
+
+  _sent = len;
+  _frameEnd = len;
+  _ack = len;
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+
+// The frames are already encoded : as many bytes as the TCP window takes, betweenFrames() keeps
+// control frames out until a frame is complete
+size_t AsyncWebSocketBatchMessage::send(AsyncClient *client)
+{
+  if (_status != WS_MSG_SENDING)
+    return 0;
+
+  if (_acked < _ack)
+  {
+    return 0;
+  }
+
+  if (_sent == _len)
+  {
+    if (_acked == _ack)
+      _status = WS_MSG_SENT;
+
+    return 0;
+  }
+
+  if (!client->canSend())
+    return 0;
+
+  size_t toSend = _len - _sent;
+  size_t space = client->space();
+
+  if (space < toSend)
+  {
+    toSend = space;
+  }
+
+  if (!toSend)
+    return 0;
+
+  size_t added = client->add((const char *)(_data + _sent), toSend);
+
+  _sent += added;
+  _ack += added;
+
+  while (_frameEnd < _sent)
+    _frameEnd += webSocketFrameLength(_data + _frameEnd);
+
+  if (!added || !client->send())
+  {
+    AWS_LOGDEBUG1(F("AsyncWebSocketBatchMessage: error sending (bytes):"), toSend);
+  }
+
+  return added;
+}
+
+/////////////////////////////////////////////////
+/////////////////////////////////////////////////
+
+/*
+   AsyncWebSocketFrameMessage Message
+*/
+
+AsyncWebSocketFrameMessage::AsyncWebSocketFrameMessage(AsyncWebSocketMessageBuffer * frame)
+  : _frame(frame)
+  , _sent(0)
+  , _ack(0)
+  , _acked(0)
+{
+  if (_frame && _frame->get())
+  {
+    (*_frame)++;
+    _status = WS_MSG_SENDING;
+  }
+  else
+  {
+    _frame = nullptr;
+    _status = WS_MSG_ERROR;
+  }
+}
+
+/////////////////////////////////////////////////
+
+AsyncWebSocketFrameMessage::~AsyncWebSocketFrameMessage()
+{
+  if (_frame)
+  {
+    (*_frame)--;
+  }
+}
+
+/////////////////////////////////////////////////
+
+void AsyncWebSocketFrameMessage::ack(size_t len, uint32_t time)
+{
+  WT32_ETH01_AWS_UNUSED(time);
+
+  _acked += len;
+
+  if (_sent == _frame->length() && _acked == _ack)
+  {
+    _status = WS_MSG_SENT;
+  }
+}
+
+/////////////////////////////////////////////////
+
+bool AsyncWebSocketFrameMessage::addComplete(AsyncClient *client, size_t window)
+{
+  const size_t len = _frame->length();
+
+  if (_status != WS_MSG_SENDING || _sent || !len || len > window)
+    return false;
+
+  if (client->add((const char *) _frame->get(), len) != len)
+    return false;
+
+  _sent = len;
+  _ack = len;
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+
+// Same bytes for every client, nothing to encode nor mask here
+size_t AsyncWebSocketFrameMessage::send(AsyncClient *client)
+{
+  if (_status != WS_MSG_SENDING)
+    return 0;
+
+  if (_acked < _ack)
+  {
+    return 0;
+  }
+
+  const size_t len = _frame->length();
+
+  if (_sent == len)
+  {
+    if (_acked == _ack)
+      _status = WS_MSG_SENT;
+
+    return 0;
+  }
+
+  if (!client->canSend())
+    return 0;
+
+  size_t toSend = len - _sent;
+  size_t space = client->space();
+
+  if (space < toSend)
+  {
+    toSend = space;
+  }
+
+  if (!toSend)
+    return 0;
+
+  size_t added = client->add((const char *)(_frame->get() + _sent), toSend);
+
+  _sent += added;
+  _ack += added;
+
+  if (!added || !client->send())
+  {
+    AWS_LOGDEBUG1(F("AsyncWebSocketFrameMessage: error sending (bytes):"), toSend);
+  }
+
+  return added;
+}
+
+/////////////////////////////////////////////////
+/////////////////////////////////////////////////
+
+/*
+   Async WebSocket Client
+*/
+const char * AWSC_PING_PAYLOAD = "AsyncWebServer_WT32-PING";
+const size_t AWSC_PING_PAYLOAD_LEN = 22;
+
+/////////////////////////////////////////////////
+
+AsyncWebSocketClient::AsyncWebSocketClient(AsyncWebServerRequest *request, AsyncWebSocket *server,
+                                           const AwsDeflateParams *deflate)
+  : _deflater(NULL)
+  , _inflateBuffer(NULL)
+  , _inflateLen(0)
+  , _inflateCapacity(0)
+  , _inflateOpcode(0)
+  , _tempObject(NULL)
+{
+  if (deflate)
+  {
+    _deflate = *deflate;
+  }
+  else
+  {
+    _deflate.windowBits = 0;
+    _deflate.noContextTakeover = false;
+    _deflate.maxMessageSize = 0;
+  }
+
+  _client = request->client();
+  _server = server;
+  _clientId = _server->_getNextId();
+  _status = WS_CONNECTED;
+  _pstate = 0;
+  _protocolError = false;
+  _lastMessageTime = millis();
+  _keepAlivePeriod = 0;
+  _corkDelay = 0;
+  _corkStart = 0;
+  _client->setRxTimeout(0);
+
+  _client->onError([](void *r, AsyncClient * c, int8_t error)
+  {
+    WT32_ETH01_AWS_UNUSED(c);
+    ((AsyncWebSocketClient*)(r))->_onError(error);
+  }, this);
+
+  _client->onAck([](void *r, AsyncClient * c, size_t len, uint32_t time)
+  {
+    WT32_ETH01_AWS_UNUSED(c);
+    ((AsyncWebSocketClient*)(r))->_onAck(len, time);
+  }, this);
+
+  _client->onDisconnect([](void *r, AsyncClient * c)
+  {
+    ((AsyncWebSocketClient*)(r))->_onDisconnect();
+    delete c;
+  }, this);
+
+  _client->onTimeout([](void *r, AsyncClient * c, uint32_t time)
+  {
+    WT32_ETH01_AWS_UNUSED(c);
+    ((AsyncWebSocketClient*)(r))->_onTimeout(time);
+  }, this);
+
+  _client->onData([](void *r, AsyncClient * c, void *buf, size_t len)
+  {
+    WT32_ETH01_AWS_UNUSED(c);
+    ((AsyncWebSocketClient*)(r))->_onData(buf, len);
+  }, this);
+
+  _client->onPoll([](void *r, AsyncClient * c)
+  {
+    WT32_ETH01_AWS_UNUSED(c);
+    ((AsyncWebSocketClient*)(r))->_onPoll();
+  }, this);
+
+  _server->_addClient(this);
+  _server->_handleEvent(this, WS_EVT_CONNECT, request, NULL, 0);
+  delete request;
+}
+
+/////////////////////////////////////////////////
+
+AsyncWebSocketClient::~AsyncWebSocketClient()
+{
+  while (!_messageQueue.isEmpty())
+    delete _messageQueue.removeFront();
+
+  while (!_controlQueue.isEmpty())
+    delete _controlQueue.removeFront();
+
+  delete _deflater;
+  free(_inflateBuffer);
+  _server->_handleEvent(this, WS_EVT_DISCONNECT, NULL, NULL, 0);
+}
+
+/////////////////////////////////////////////////
+
+void AsyncWebSocketClient::_onAck(size_t len, uint32_t time)
+{
+  // The queues are also used by the cork task and by the tasks sending messages
+  AsyncWebLockGuard l(_server->_getLock());
+
+  _lastMessageTime = millis();
+
+  if (!_controlQueue.isEmpty())
+  {
+    auto head = _controlQueue.front();
+
+    if (head->finished())
+    {
+      _controlQueue.removeFront();
+
+      len = (len > head->len()) ? len - head->len() : 0;
+
+      if (_status == WS_DISCONNECTING && head->opcode() == WS_DISCONNECT)
       {
-        _controlQueue.remove(head);
+        delete head;
         _status = WS_DISCONNECTED;
         _client->close(true);
         return;
       }
 
-      _controlQueue.remove(head);
+      delete head;
     }
   }
 
-  if (len && !_messageQueue.isEmpty())
+  // Several messages may be in flight : each takes its share, in the order they were sent.
+  // The front takes everything when it doesn't count its bytes in flight, as before
+  for (size_t i = 0; len && i < _messageQueue.length(); i++)
   {
-    _messageQueue.front()->ack(len, time);
+    AsyncWebSocketMessage * message = _messageQueue.at(i);
+    const size_t inFlight = message->inFlight();
+
+    if (i && !inFlight)
+      break;
+
+    const size_t acked = (inFlight && inFlight < len) ? inFlight : len;
+
+    message->ack(acked, time);
+    len -= acked;
   }
 
   _server->_cleanBuffers();
@@ -747,8 +1325,23 @@ void AsyncWebSocketClient::_onAck(size_t len, uint32_t time)
 
 /////////////////////////////////////////////////
 
+// From the cork task of the server, with the server locked
+void AsyncWebSocketClient::_onCork()
+{
+  AsyncWebLockGuard l(_server->_getLock());
+
+  if (_corkDelay && _client->canSend() && !_messageQueue.isEmpty())
+  {
+    _runQueue();
+  }
+}
+
+/////////////////////////////////////////////////
+
 void AsyncWebSocketClient::_onPoll()
 {
+  AsyncWebLockGuard l(_server->_getLock());
+
   if (_client->canSend() && (!_controlQueue.isEmpty() || !_messageQueue.isEmpty()))
   {
     _runQueue();
@@ -766,17 +1359,57 @@ void AsyncWebSocketClient::_runQueue()
 {
   while (!_messageQueue.isEmpty() && _messageQueue.front()->finished())
   {
-    _messageQueue.remove(_messageQueue.front());
+    delete _messageQueue.removeFront();
   }
 
-  if (!_controlQueue.isEmpty() && (_messageQueue.isEmpty() || _messageQueue.front()->betweenFrames()) &&
+  // A control frame stays at the front until acked : sent once, not again with every ack
+  if (!_controlQueue.isEmpty() && !_controlQueue.front()->finished() &&
+      (_messageQueue.isEmpty() || _messageQueue.front()->betweenFrames()) &&
       webSocketSendFrameWindow(_client) > (size_t)(_controlQueue.front()->len() - 1))
   {
     _controlQueue.front()->send(_client);
   }
-  else if (!_messageQueue.isEmpty() && _messageQueue.front()->betweenFrames() && webSocketSendFrameWindow(_client))
+  else if (!_messageQueue.isEmpty() && _messageQueue.front()->acked() && webSocketSendFrameWindow(_client))
   {
-    _messageQueue.front()->send(_client);
+    // Cork : wait for more messages, up to _corkDelay ms after the first one, unless the queue is full
+    if (_corkDelay && !_messageQueue.isFull())
+    {
+      const uint32_t corked = millis() - _corkStart;
+
+      if (corked < _corkDelay)
+      {
+        _server->_armCork(_corkDelay - corked);
+
+        return;
+      }
+    }
+
+    _sendMessages();
+  }
+}
+
+/////////////////////////////////////////////////
+
+// Complete messages that fit go into the TCP buffer one after another, then out in a single write.
+// The first one that doesn't fit is sent last, one frame at a time as before
+void AsyncWebSocketClient::_sendMessages()
+{
+  size_t index = 0;
+
+  while (index < _messageQueue.length() &&
+         _messageQueue.at(index)->addComplete(_client, webSocketSendFrameWindow(_client)))
+  {
+    index++;
+  }
+
+  if (index < _messageQueue.length() && webSocketSendFrameWindow(_client))
+  {
+    _messageQueue.at(index)->send(_client);
+  }
+
+  if (index && !_client->send())
+  {
+    AWS_LOGDEBUG1(F("AsyncWebSocketClient: error sending messages:"), index);
   }
 }
 
@@ -784,7 +1417,7 @@ void AsyncWebSocketClient::_runQueue()
 
 bool AsyncWebSocketClient::queueIsFull()
 {
-  if ((_messageQueue.length() >= WS_MAX_QUEUED_MESSAGES) || (_status != WS_CONNECTED) )
+  if (_messageQueue.isFull() || (_status != WS_CONNECTED) )
     return true;
 
   return false;
@@ -792,43 +1425,213 @@ bool AsyncWebSocketClient::queueIsFull()
 
 /////////////////////////////////////////////////
 
-void AsyncWebSocketClient::_queueMessage(AsyncWebSocketMessage *dataMessage)
+void AsyncWebSocketClient::_queueMessage(AsyncWebSocketMessage *dataMessage)
+{
+  if (dataMessage == NULL)
+    return;
+
+  AsyncWebLockGuard l(_server->_getLock());
+
+  if (_status != WS_CONNECTED)
+  {
+    delete dataMessage;
+    return;
+  }
+
+  if (_messageQueue.isFull())
+  {
+    AWS_LOGDEBUG("ERROR: Too many messages queued");
+
+    delete dataMessage;
+  }
+  else
+  {
+    if (_messageQueue.isEmpty())
+      _corkStart = millis();
+
+    // Compressed in queue order, the order the client decompresses them
+    if (_deflate.windowBits)
+      _deflateMessage(dataMessage);
+
+    _messageQueue.add(dataMessage);
+  }
+
+  if (_client->canSend())
+    _runQueue();
+}
+
+/////////////////////////////////////////////////
+
+void AsyncWebSocketClient::_queueControl(AsyncWebSocketControl *controlMessage)
+{
+  if (controlMessage == NULL)
+    return;
+
+  AsyncWebLockGuard l(_server->_getLock());
+
+  // The last slot is kept for a close frame, or a ping flood would leave the connection never closing
+  const bool isClose = (controlMessage->opcode() == WS_DISCONNECT);
+  const bool full = isClose ? _controlQueue.isFull() : (_controlQueue.length() + 1 >= _controlQueue.capacity());
+
+  if (full || !_controlQueue.add(controlMessage))
+  {
+    AWS_LOGDEBUG("ERROR: Too many control messages queued");
+
+    delete controlMessage;
+
+    // No room even for the close frame : close the TCP connection instead
+    if (isClose)
+    {
+      _status = WS_DISCONNECTED;
+      _client->close(true);
+    }
+
+    return;
+  }
+
+  if (_client->canSend())
+    _runQueue();
+}
+
+/////////////////////////////////////////////////
+
+void AsyncWebSocketClient::_deflateMessage(AsyncWebSocketMessage *dataMessage)
+{
+  if (!dataMessage->canDeflate())
+    return;
+
+  if (!_deflater)
+    _deflater = new AsyncDeflater(AWS_ENCODING_RAW, (size_t) 1 << _deflate.windowBits);
+
+  // With context takeover, the history now holds the message : sent compressed even when not shorter.
+  // On failure the message goes uncompressed, and the next one starts a new history.
+  bool deflated = _deflater && _deflater->valid() && dataMessage->deflate(_deflater, !_deflate.noContextTakeover);
+
+  if (!deflated || _deflate.noContextTakeover)
+  {
+    delete _deflater;
+    _deflater = NULL;
+  }
+}
+
+/////////////////////////////////////////////////
+
+void AsyncWebSocketClient::_appendDeflated(const uint8_t *data, size_t len)
+{
+  // Already refused, the rest of the message is dropped
+  if (_inflateLen > _deflate.maxMessageSize)
+    return;
+
+  if (len > _deflate.maxMessageSize - _inflateLen)
+  {
+    AWS_LOGDEBUG1(F("AsyncWebSocketClient: compressed message too long, max ="), _deflate.maxMessageSize);
+
+    free(_inflateBuffer);
+    _inflateBuffer = NULL;
+    _inflateCapacity = 0;
+    _inflateLen = _deflate.maxMessageSize + 1;
+
+    // Message too big
+    close(1009);
+
+    return;
+  }
+
+  // 4 more bytes for the 00 00 FF FF added before decompressing
+  if (_inflateLen + len + 4 > _inflateCapacity)
+  {
+    size_t capacity = _inflateCapacity ? _inflateCapacity << 1 : 256;
+
+    while (capacity < _inflateLen + len + 4)
+      capacity <<= 1;
+
+    if (capacity > _deflate.maxMessageSize + 4)
+      capacity = _deflate.maxMessageSize + 4;
+
+    uint8_t * buffer = (uint8_t *) realloc(_inflateBuffer, capacity);
+
+    if (!buffer)
+    {
+      AWS_LOGERROR1(F("AsyncWebSocketClient: realloc failed, size ="), capacity);
+
+      free(_inflateBuffer);
+      _inflateBuffer = NULL;
+      _inflateCapacity = 0;
+      _inflateLen = _deflate.maxMessageSize + 1;
+
+      // Internal error
+      close(1011);
+
+      return;
+    }
+
+    _inflateBuffer = buffer;
+    _inflateCapacity = capacity;
+  }
+
+  if (len)
+  {
+    memcpy(_inflateBuffer + _inflateLen, data, len);
+    _inflateLen += len;
+  }
+}
+
+/////////////////////////////////////////////////
+
+// Last frame received : the whole message goes to the event handler as one frame
+void AsyncWebSocketClient::_inflateMessage()
 {
-  if (dataMessage == NULL)
-    return;
+  const uint8_t opcode = _inflateOpcode;
 
-  if (_status != WS_CONNECTED)
+  _inflateOpcode = 0;
+
+  if (_inflateLen > _deflate.maxMessageSize)
   {
-    delete dataMessage;
+    _inflateLen = 0;
+
     return;
   }
 
-  if (_messageQueue.length() >= WS_MAX_QUEUED_MESSAGES)
+  // Even an empty message needs the buffer
+  _appendDeflated(NULL, 0);
+
+  if (!_inflateBuffer)
+    return;
+
+  static const uint8_t flushTail[4] = { 0x00, 0x00, 0xFF, 0xFF };
+
+  memcpy(_inflateBuffer + _inflateLen, flushTail, sizeof(flushTail));
+
+  AsyncInflater * inflater = new AsyncInflater(_deflate.maxMessageSize);
+  bool inflated = inflater && inflater->inflate(_inflateBuffer, _inflateLen + sizeof(flushTail));
+
+  free(_inflateBuffer);
+  _inflateBuffer = NULL;
+  _inflateCapacity = 0;
+  _inflateLen = 0;
+
+  if (inflated)
   {
-    AWS_LOGDEBUG("ERROR: Too many messages queued");
+    AwsFrameInfo info = _pinfo;
 
-    delete dataMessage;
+    info.message_opcode = opcode;
+    info.opcode = opcode;
+    info.num = 0;
+    info.final = 1;
+    info.index = 0;
+    info.len = inflater->length();
+
+    _server->_handleEvent(this, WS_EVT_DATA, (void *)&info, inflater->data(), inflater->length());
   }
   else
   {
-    _messageQueue.add(dataMessage);
-  }
-
-  if (_client->canSend())
-    _runQueue();
-}
+    AWS_LOGDEBUG(F("AsyncWebSocketClient: invalid compressed message"));
 
-/////////////////////////////////////////////////
-
-void AsyncWebSocketClient::_queueControl(AsyncWebSocketControl *controlMessage)
-{
-  if (controlMessage == NULL)
-    return;
-
-  _controlQueue.add(controlMessage);
+    // Message too big, or invalid payload data
+    close((inflater && inflater->overflow()) ? 1009 : 1007);
+  }
 
-  if (_client->canSend())
-    _runQueue();
+  delete inflater;
 }
 
 /////////////////////////////////////////////////
@@ -907,6 +1710,9 @@ void AsyncWebSocketClient::_onDisconnect()
 
 void AsyncWebSocketClient::_onData(void *pbuf, size_t plen)
 {
+  if (_protocolError)
+    return;
+
   _lastMessageTime = millis();
   uint8_t *data = (uint8_t*)pbuf;
 
@@ -944,6 +1750,27 @@ void AsyncWebSocketClient::_onData(void *pbuf, size_t plen)
         data += 4;
         plen -= 4;
       }
+
+      // RSV1 only on the first frame of a message, with permessage-deflate (RFC 7692 6.1). No extension uses RSV2 / RSV3
+      if ( (fdata[0] & 0x30) || ((fdata[0] & WS_RSV1)
+                                 && (!_deflate.windowBits || (_pinfo.opcode != WS_TEXT && _pinfo.opcode != WS_BINARY))) )
+      {
+        AWS_LOGDEBUG1(F("AsyncWebSocketClient: reserved bits set, opcode ="), _pinfo.opcode);
+
+        _protocolError = true;
+
+        // Protocol error
+        close(1002);
+
+        return;
+      }
+
+      // First frame of a compressed message : its frames are gathered, and decompressed after the last one
+      if (_deflate.windowBits && (_pinfo.opcode == WS_TEXT || _pinfo.opcode == WS_BINARY))
+      {
+        _inflateOpcode = (fdata[0] & WS_RSV1) ? _pinfo.opcode : 0;
+        _inflateLen = 0;
+      }
     }
 
     const size_t datalen = std::min((size_t)(_pinfo.len - _pinfo.index), plen);
@@ -951,8 +1778,7 @@ void AsyncWebSocketClient::_onData(void *pbuf, size_t plen)
 
     if (_pinfo.masked)
     {
-      for (size_t i = 0; i < datalen; i++)
-        data[i] ^= _pinfo.mask[(_pinfo.index + i) % 4];
+      webSocketMask(data, datalen, _pinfo.mask, _pinfo.index);
     }
 
     if ((datalen + _pinfo.index) < _pinfo.len)
@@ -970,7 +1796,10 @@ void AsyncWebSocketClient::_onData(void *pbuf, size_t plen)
           _pinfo.num += 1;
       }
 
-      _server->_handleEvent(this, WS_EVT_DATA, (void *)&_pinfo, (uint8_t*)data, datalen);
+      if (_inflateOpcode && _pinfo.opcode < 8)
+        _appendDeflated(data, datalen);
+      else
+        _server->_handleEvent(this, WS_EVT_DATA, (void *)&_pinfo, (uint8_t*)data, datalen);
 
       _pinfo.index += datalen;
     }
@@ -1012,6 +1841,13 @@ void AsyncWebSocketClient::_onData(void *pbuf, size_t plen)
         if (datalen != AWSC_PING_PAYLOAD_LEN || memcmp(AWSC_PING_PAYLOAD, data, AWSC_PING_PAYLOAD_LEN) != 0)
           _server->_handleEvent(this, WS_EVT_PONG, NULL, data, datalen);
       }
+      else if (_pinfo.opcode < 8 && _inflateOpcode)
+      {
+        _appendDeflated(data, datalen);
+
+        if (_pinfo.final)
+          _inflateMessage();
+      }
       else if (_pinfo.opcode < 8)
       {
         //continuation or text/binary frame
@@ -1257,11 +2093,116 @@ AsyncWebSocket::AsyncWebSocket(const String& url)
 }))
 {
   _eventHandler = NULL;
+
+  _deflate.windowBits = 0;
+  _deflate.noContextTakeover = false;
+  _deflate.maxMessageSize = WS_DEFLATE_MAX_MESSAGE_SIZE;
+
+  _corkTask = NULL;
+  _corkArmed = false;
+  _corkDue = 0;
+}
+
+/////////////////////////////////////////////////
+
+void AsyncWebSocket::setCompression(uint8_t windowBits, bool noContextTakeover, size_t maxMessageSize)
+{
+  // Window of AsyncDeflater : 1 KB to 16 KB
+  if (windowBits && windowBits < 10)
+    windowBits = 10;
+  else if (windowBits > 14)
+    windowBits = 14;
+
+  _deflate.windowBits = windowBits;
+  _deflate.noContextTakeover = noContextTakeover;
+  _deflate.maxMessageSize = maxMessageSize;
+}
+
+/////////////////////////////////////////////////
+
+AsyncWebSocket::~AsyncWebSocket()
+{
+  if (_corkTask)
+  {
+    // Locked : the task is not sending meanwhile
+    AsyncWebLockGuard l(_lock);
+
+    vTaskDelete(_corkTask);
+  }
+}
+
+/////////////////////////////////////////////////
+
+// Wakes the cork task up for the earliest end of a client's cork delay. Without the task, the next ack or poll
+// sends the messages. A task rather than a timer callback : sending blocks on the lock and on lwIP
+void AsyncWebSocket::_armCork(uint32_t delay)
+{
+  AsyncWebLockGuard l(_lock);
+
+  const uint32_t due = millis() + delay;
+
+  if (_corkArmed && (int32_t)(due - _corkDue) >= 0)
+    return;
+
+  if (!_corkTask)
+  {
+    auto loop = [](void *arg)
+    {
+      AsyncWebSocket* server = (AsyncWebSocket*)(arg);
+
+      for (;;)
+      {
+        const uint32_t wait = server->_onCorkTimer();
+
+        // Woken up earlier by _armCork() for a closer delay
+        ulTaskNotifyTake(pdTRUE, (wait == UINT32_MAX) ? portMAX_DELAY : pdMS_TO_TICKS(wait) + 1);
+      }
+    };
+
+    if (xTaskCreate(loop, "ws_cork", WS_CORK_TASK_STACK_SIZE, this, WS_CORK_TASK_PRIORITY, &_corkTask) != pdPASS)
+    {
+      AWS_LOGERROR("AsyncWebSocket: can't create the cork task");
+
+      _corkTask = NULL;
+
+      return;
+    }
+  }
+
+  _corkArmed = true;
+  _corkDue = due;
+
+  xTaskNotifyGive(_corkTask);
 }
 
 /////////////////////////////////////////////////
 
-AsyncWebSocket::~AsyncWebSocket() {}
+// In the cork task. Locked : a client can't be deleted by _handleDisconnect(), nor its queues used, meanwhile.
+// Returns the ms to wait for the next cork delay to end, UINT32_MAX if none
+uint32_t AsyncWebSocket::_onCorkTimer()
+{
+  AsyncWebLockGuard l(_lock);
+
+  if (_corkArmed && (int32_t)(_corkDue - millis()) <= 0)
+  {
+    _corkArmed = false;
+
+    // May arm it again, for clients still waiting
+    for (const auto& c : _clients)
+    {
+      c->_onCork();
+    }
+  }
+
+  if (!_corkArmed)
+    return UINT32_MAX;
+
+  const int32_t left = (int32_t)(_corkDue - millis());
+
+  return (left > 0) ? (uint32_t) left : 0;
+}
+
+/////////////////////////////////////////////////
 
 void AsyncWebSocket::_handleEvent(AsyncWebSocketClient * client, AwsEventType type, void * arg, uint8_t *data,
                                   size_t len)
@@ -1276,6 +2217,8 @@ void AsyncWebSocket::_handleEvent(AsyncWebSocketClient * client, AwsEventType ty
 
 void AsyncWebSocket::_addClient(AsyncWebSocketClient * client)
 {
+  AsyncWebLockGuard l(_lock);
+
   _clients.add(client);
 }
 
@@ -1283,6 +2226,7 @@ void AsyncWebSocket::_addClient(AsyncWebSocketClient * client)
 
 void AsyncWebSocket::_handleDisconnect(AsyncWebSocketClient * client)
 {
+  AsyncWebLockGuard l(_lock);
 
   _clients.remove_first([ = ](AsyncWebSocketClient * c)
   {
@@ -1405,31 +2349,20 @@ void AsyncWebSocket::text(uint32_t id, const char * message, size_t len)
 
 /////////////////////////////////////////////////
 
+// The payload is copied once into the frame, the buffer is then freed by _cleanBuffers()
 void AsyncWebSocket::textAll(AsyncWebSocketMessageBuffer * buffer)
 {
   if (!buffer)
     return;
 
-  buffer->lock();
-
-  for (const auto& c : _clients)
-  {
-    if (c->status() == WS_CONNECTED)
-    {
-      c->text(buffer);
-    }
-  }
-
-  buffer->unlock();
-  _cleanBuffers();
+  _sendAll(WS_TEXT, buffer->get(), buffer->length());
 }
 
 /////////////////////////////////////////////////
 
 void AsyncWebSocket::textAll(const char * message, size_t len)
 {
-  AsyncWebSocketMessageBuffer * WSBuffer = makeBuffer((uint8_t *)message, len);
-  textAll(WSBuffer);
+  _sendAll(WS_TEXT, (const uint8_t *)message, len);
 }
 
 /////////////////////////////////////////////////
@@ -1446,8 +2379,7 @@ void AsyncWebSocket::binary(uint32_t id, const char * message, size_t len)
 
 void AsyncWebSocket::binaryAll(const char * message, size_t len)
 {
-  AsyncWebSocketMessageBuffer * buffer = makeBuffer((uint8_t *)message, len);
-  binaryAll(buffer);
+  _sendAll(WS_BINARY, (const uint8_t *)message, len);
 }
 
 /////////////////////////////////////////////////
@@ -1457,15 +2389,129 @@ void AsyncWebSocket::binaryAll(AsyncWebSocketMessageBuffer * buffer)
   if (!buffer)
     return;
 
-  buffer->lock();
+  _sendAll(WS_BINARY, buffer->get(), buffer->length());
+}
+
+/////////////////////////////////////////////////
+
+// Header and payload in one shared buffer, the payload from flash when progmem
+AsyncWebSocketMessageBuffer * AsyncWebSocket::_makeFrame(uint8_t opcode, const uint8_t * data, size_t len, bool progmem)
+{
+  uint8_t head[WS_MAX_HEADER_SIZE];
+  const size_t headLen = webSocketFrameHeader(head, true, opcode, NULL, len);
+
+  AsyncWebSocketMessageBuffer * frame = makeBuffer(headLen + len);
+
+  // Without memory, an empty buffer is left to _cleanBuffers()
+  if (!frame || !frame->get())
+    return NULL;
+
+  memcpy(frame->get(), head, headLen);
+
+  if (len && data)
+  {
+    if (progmem)
+      memcpy_P(frame->get() + headLen, data, len);
+    else
+      memcpy(frame->get() + headLen, data, len);
+  }
+
+  return frame;
+}
+
+/////////////////////////////////////////////////
+
+// Compressed once too, for the clients without context takeover : their messages don't depend on the previous ones
+AsyncWebSocketMessageBuffer * AsyncWebSocket::_makeDeflatedFrame(uint8_t opcode, const uint8_t * data, size_t len,
+                                                                 bool progmem, uint8_t windowBits)
+{
+  AsyncDeflater deflater(AWS_ENCODING_RAW, (size_t) 1 << windowBits);
+
+  if (!deflater.valid())
+    return NULL;
+
+  size_t deflatedLen;
+  uint8_t * deflated = webSocketDeflate(&deflater, data, len, deflatedLen, progmem);
+
+  if (!deflated)
+    return NULL;
+
+  AsyncWebSocketMessageBuffer * frame = NULL;
+
+  if (deflatedLen < len)
+    frame = _makeFrame(opcode | WS_RSV1, deflated, deflatedLen);
+
+  free(deflated);
+
+  return frame;
+}
+
+/////////////////////////////////////////////////
+
+void AsyncWebSocket::_sendAll(uint8_t opcode, const uint8_t * data, size_t len, bool progmem)
+{
+  // Both built on first use
+  AsyncWebSocketMessageBuffer * frame = NULL;
+  AsyncWebSocketMessageBuffer * deflatedFrame = NULL;
+  uint8_t deflatedBits = 0;
 
   for (const auto& c : _clients)
   {
-    if (c->status() == WS_CONNECTED)
-      c->binary(buffer);
+    if (c->status() != WS_CONNECTED)
+      continue;
+
+    const AwsDeflateParams& deflate = c->deflateParams();
+
+    if (deflate.windowBits && len >= WS_DEFLATE_MIN_SIZE)
+    {
+      if (!deflate.noContextTakeover)
+      {
+        // Compressed with the client's own history when queued
+        c->message(new AsyncWebSocketBasicMessage((const char *) data, len, opcode));
+
+        continue;
+      }
+
+      // A frame compressed with a smaller window decodes with a larger one
+      if (!deflatedBits)
+      {
+        deflatedBits = deflate.windowBits;
+        deflatedFrame = _makeDeflatedFrame(opcode, data, len, progmem, deflatedBits);
+
+        if (deflatedFrame)
+          deflatedFrame->lock();
+      }
+
+      if (deflatedFrame)
+      {
+        if (deflate.windowBits >= deflatedBits)
+          c->message(new AsyncWebSocketFrameMessage(deflatedFrame));
+        else
+          c->message(new AsyncWebSocketBasicMessage((const char *) data, len, opcode));
+
+        continue;
+      }
+    }
+
+    if (!frame)
+    {
+      frame = _makeFrame(opcode, data, len, progmem);
+
+      if (!frame)
+        break;
+
+      frame->lock();
+    }
+
+    c->message(new AsyncWebSocketFrameMessage(frame));
   }
 
-  buffer->unlock();
+  if (frame)
+    frame->unlock();
+
+  if (deflatedFrame)
+    deflatedFrame->unlock();
+
   _cleanBuffers();
 }
 
@@ -1647,11 +2693,9 @@ void AsyncWebSocket::textAll(const String &message)
 
 void AsyncWebSocket::textAll(const __FlashStringHelper *message)
 {
-  for (const auto& c : _clients)
-  {
-    if (c->status() == WS_CONNECTED)
-      c->text(message);
-  }
+  PGM_P p = reinterpret_cast<PGM_P>(message);
+
+  _sendAll(WS_TEXT, (const uint8_t *)p, strlen_P(p), true);
 }
 
 /////////////////////////////////////////////////
@@ -1724,11 +2768,7 @@ void AsyncWebSocket::binaryAll(const String &message)
 
 void AsyncWebSocket::binaryAll(const __FlashStringHelper *message, size_t len)
 {
-  for (const auto& c : _clients)
-  {
-    if (c->status() == WS_CONNECTED)
-      c-> binary(message, len);
-  }
+  _sendAll(WS_BINARY, (const uint8_t *)reinterpret_cast<PGM_P>(message), len, true);
 }
 
 /////////////////////////////////////////////////
@@ -1740,6 +2780,7 @@ const char * WS_STR_VERSION    = "Sec-WebSocket-Version";
 const char * WS_STR_KEY        = "Sec-WebSocket-Key";
 const char * WS_STR_PROTOCOL   = "Sec-WebSocket-Protocol";
 const char * WS_STR_ACCEPT     = "Sec-WebSocket-Accept";
+const char * WS_STR_EXTENSIONS = "Sec-WebSocket-Extensions";
 const char * WS_STR_UUID       = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
 
 /////////////////////////////////////////////////
@@ -1758,6 +2799,7 @@ bool AsyncWebSocket::canHandle(AsyncWebServerRequest *request)
   request->addInterestingHeader(WS_STR_VERSION);
   request->addInterestingHeader(WS_STR_KEY);
   request->addInterestingHeader(WS_STR_PROTOCOL);
+  request->addInterestingHeader(WS_STR_EXTENSIONS);
 
   return true;
 }
@@ -1789,8 +2831,34 @@ void AsyncWebSocket::handleRequest(AsyncWebServerRequest *request)
     return;
   }
 
+  // First acceptable permessage-deflate offer, if compression is enabled
+  AwsDeflateParams deflate = { 0, false, 0 };
+  String extension;
+
+  if (_deflate.windowBits && request->hasHeader(WS_STR_EXTENSIONS))
+  {
+    const String& offers = request->getHeader(WS_STR_EXTENSIONS)->value();
+    int start = 0;
+
+    while (start < (int) offers.length())
+    {
+      int end = offers.indexOf(',', start);
+
+      if (end < 0)
+        end = offers.length();
+
+      if (_acceptDeflateOffer(offers.substring(start, end), deflate, extension))
+        break;
+
+      start = end + 1;
+    }
+  }
+
   AsyncWebHeader* key = request->getHeader(WS_STR_KEY);
-  AsyncWebServerResponse *response = new AsyncWebSocketResponse(key->value(), this);
+  AsyncWebServerResponse *response = new AsyncWebSocketResponse(key->value(), this, &deflate);
+
+  if (deflate.windowBits)
+    response->addHeader(WS_STR_EXTENSIONS, extension);
 
   if (request->hasHeader(WS_STR_PROTOCOL))
   {
@@ -1804,6 +2872,130 @@ void AsyncWebSocket::handleRequest(AsyncWebServerRequest *request)
 
 /////////////////////////////////////////////////
 
+// One offer : "permessage-deflate; server_no_context_takeover; server_max_window_bits=10; ...".
+// An offer with unknown, repeated or invalid parameters is declined (RFC 7692 5)
+bool AsyncWebSocket::_acceptDeflateOffer(const String& offer, AwsDeflateParams& params, String& extension)
+{
+  enum
+  {
+    SERVER_NO_CONTEXT_TAKEOVER  = 1,
+    CLIENT_NO_CONTEXT_TAKEOVER  = 2,
+    SERVER_MAX_WINDOW_BITS      = 4,
+    CLIENT_MAX_WINDOW_BITS      = 8
+  };
+
+  uint8_t windowBits = _deflate.windowBits;
+  bool noContextTakeover = _deflate.noContextTakeover;
+  uint8_t seen = 0;
+  int start = 0;
+  bool first = true;
+
+  while (start <= (int) offer.length())
+  {
+    int end = offer.indexOf(';', start);
+
+    if (end < 0)
+      end = offer.length();
+
+    String name = offer.substring(start, end);
+    String value;
+    bool hasValue = false;
+    int equal = name.indexOf('=');
+
+    start = end + 1;
+
+    if (equal >= 0)
+    {
+      value = name.substring(equal + 1);
+      value.trim();
+      name = name.substring(0, equal);
+      hasValue = true;
+
+      if (value.length() >= 2 && value.startsWith("\"") && value.endsWith("\""))
+        value = value.substring(1, value.length() - 1);
+    }
+
+    name.trim();
+
+    if (first)
+    {
+      if (!name.equalsIgnoreCase("permessage-deflate") || hasValue)
+        return false;
+
+      first = false;
+
+      continue;
+    }
+
+    // "permessage-deflate;"
+    if (!name.length() && !hasValue)
+      continue;
+
+    uint8_t param;
+
+    if (name.equalsIgnoreCase("server_no_context_takeover") && !hasValue)
+    {
+      param = SERVER_NO_CONTEXT_TAKEOVER;
+      noContextTakeover = true;
+    }
+    else if (name.equalsIgnoreCase("client_no_context_takeover") && !hasValue)
+    {
+      // Always answered
+      param = CLIENT_NO_CONTEXT_TAKEOVER;
+    }
+    else if (name.equalsIgnoreCase("server_max_window_bits") && hasValue)
+    {
+      long bits = value.toInt();
+
+      // Below 10 : smaller than the compressor's smallest window
+      if (bits < 10 || bits > 15)
+        return false;
+
+      param = SERVER_MAX_WINDOW_BITS;
+
+      if (bits < windowBits)
+        windowBits = bits;
+    }
+    else if (name.equalsIgnoreCase("client_max_window_bits"))
+    {
+      // Without client context takeover, each message is decoded on its own : any client window will do
+      if (hasValue && (value.toInt() < 8 || value.toInt() > 15))
+        return false;
+
+      param = CLIENT_MAX_WINDOW_BITS;
+    }
+    else
+    {
+      return false;
+    }
+
+    if (seen & param)
+      return false;
+
+    seen |= param;
+  }
+
+  params.windowBits = windowBits;
+  params.noContextTakeover = noContextTakeover;
+  params.maxMessageSize = _deflate.maxMessageSize;
+
+  extension = "permessage-deflate; client_no_context_takeover";
+
+  if (noContextTakeover)
+    extension += "; server_no_context_takeover";
+
+  // Answer required when offered
+  if (seen & SERVER_MAX_WINDOW_BITS)
+  {
+    extension += "; server_max_window_bits=";
+    extension += String(windowBits);
+  }
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+
 AsyncWebSocketMessageBuffer * AsyncWebSocket::makeBuffer(size_t size)
 {
   AsyncWebSocketMessageBuffer * buffer = new AsyncWebSocketMessageBuffer(size);
@@ -1838,13 +3030,11 @@ void AsyncWebSocket::_cleanBuffers()
 {
   AsyncWebLockGuard l(_lock);
 
-  for (AsyncWebSocketMessageBuffer * c : _buffers)
+  // Every broadcast leaves its frame here : removing while iterating would step on the freed node
+  while (_buffers.remove_first([](AsyncWebSocketMessageBuffer * c)
   {
-    if (c && c->canDelete())
-    {
-      _buffers.remove(c);
-    }
-  }
+    return c && c->canDelete();
+  }));
 }
 
 /////////////////////////////////////////////////
@@ -1862,9 +3052,22 @@ AsyncWebSocket::AsyncWebSocketClientLinkedList AsyncWebSocket::getClients() cons
    Authentication code from https://github.com/Links2004/arduinoWebSockets/blob/master/src/WebSockets.cpp#L480
 */
 
-AsyncWebSocketResponse::AsyncWebSocketResponse(const String & key, AsyncWebSocket * server)
+AsyncWebSocketResponse::AsyncWebSocketResponse(const String & key, AsyncWebSocket * server,
+                                               const AwsDeflateParams * deflate)
 {
   _server = server;
+
+  if (deflate)
+  {
+    _deflate = *deflate;
+  }
+  else
+  {
+    _deflate.windowBits = 0;
+    _deflate.noContextTakeover = false;
+    _deflate.maxMessageSize = 0;
+  }
+
   _code = 101;
   _sendContentLength = false;
 
@@ -1930,7 +3133,7 @@ size_t AsyncWebSocketResponse::_ack(AsyncWebServerRequest *request, size_t len,
 
   if (len)
   {
-    new AsyncWebSocketClient(request, _server);
+    new AsyncWebSocketClient(request, _server, &_deflate);
   }
 
   return 0;
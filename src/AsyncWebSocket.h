@@ -50,11 +50,29 @@
 #include <Arduino.h>
 
 #include <AsyncTCP.h>
-#define WS_MAX_QUEUED_MESSAGES 32
+
+// Capacity of each client's message and control queues, the last control slot is kept for the close frame
+#ifndef WS_MAX_QUEUED_MESSAGES
+  #define WS_MAX_QUEUED_MESSAGES 32
+#endif
+
+#if (WS_MAX_QUEUED_MESSAGES < 2)
+  #error WS_MAX_QUEUED_MESSAGES must be at least 2
+#endif
+
+// Task sending the messages whose cork delay is over, created by the first corked message
+#ifndef WS_CORK_TASK_STACK_SIZE
+  #define WS_CORK_TASK_STACK_SIZE       4096
+#endif
+
+#ifndef WS_CORK_TASK_PRIORITY
+  #define WS_CORK_TASK_PRIORITY         3
+#endif
 
 #include "AsyncWebServer_WT32_ETH01.h"
 
 #include "AsyncWebSynchronization.h"
+#include "AsyncWebSocketMask.h"
 
 namespace eth {
 
@@ -62,6 +80,32 @@ namespace eth {
 
 #define DEFAULT_MAX_WS_CLIENTS 8
 
+// 2 bytes, 8 of extended length, 4 of mask key
+#define WS_MAX_HEADER_SIZE      14
+
+// Frames up to this payload are copied with their header on the stack, and added to the TCP buffer at once
+#ifndef WS_SMALL_FRAME_SIZE
+  #define WS_SMALL_FRAME_SIZE   128
+#endif
+
+// RSV1, set in the first frame of a message compressed with permessage-deflate (RFC 7692)
+#define WS_RSV1                 0x40
+
+// permessage-deflate : default window of the server's compressor, 10 (1 KB) to 14 (16 KB)
+#ifndef WS_DEFLATE_WINDOW_BITS
+  #define WS_DEFLATE_WINDOW_BITS        11
+#endif
+
+// Shorter messages are sent uncompressed
+#ifndef WS_DEFLATE_MIN_SIZE
+  #define WS_DEFLATE_MIN_SIZE           64
+#endif
+
+// Largest compressed message accepted from a client, and largest once decompressed
+#ifndef WS_DEFLATE_MAX_MESSAGE_SIZE
+  #define WS_DEFLATE_MAX_MESSAGE_SIZE   8192
+#endif
+
 /////////////////////////////////////////////////
 
 class AsyncWebSocket;
@@ -98,6 +142,29 @@ typedef struct
 
 /////////////////////////////////////////////////
 
+// permessage-deflate settings of a connection. Clients are always asked for client_no_context_takeover :
+// a received message is decompressed on its own, with no history kept between messages
+typedef struct
+{
+  uint8_t windowBits;         // Server compressor window, 0 when permessage-deflate isn't used
+  bool noContextTakeover;     // New compressor for each message, memory only held while compressing
+  size_t maxMessageSize;      // Limit of a received message, compressed or not
+} AwsDeflateParams;
+
+/////////////////////////////////////////////////
+
+// Write a frame header into buf (up to WS_MAX_HEADER_SIZE bytes), mask NULL when not masked. Returns its length.
+size_t webSocketFrameHeader(uint8_t *buf, bool final, uint8_t opcode, const uint8_t *mask, size_t len);
+
+// Add a frame to the TCP buffer, without sending it yet : several frames can go in one client->send().
+// Returns the payload bytes added, cut to the free space.
+size_t webSocketAddFrame(AsyncClient *client, bool final, uint8_t opcode, bool mask, uint8_t *data, size_t len);
+
+size_t webSocketSendFrame(AsyncClient *client, bool final, uint8_t opcode, bool mask, uint8_t *data, size_t len);
+size_t webSocketSendFrameWindow(AsyncClient *client);
+
+/////////////////////////////////////////////////
+
 typedef enum
 {
   WS_DISCONNECTED,
@@ -255,6 +322,46 @@ class AsyncWebSocketMessage
     {
       return false;
     }
+
+    /////////////////////////////////////////////////
+
+    // Everything sent so far is acked : send() can go on, possibly in the middle of a frame
+    virtual bool acked() const
+    {
+      return betweenFrames();
+    }
+
+    /////////////////////////////////////////////////
+
+    // Not sent yet, and long enough to be compressed
+    virtual bool canDeflate() const
+    {
+      return false;
+    }
+
+    /////////////////////////////////////////////////
+
+    // Compress the payload, false if left as is. With force, kept compressed even when not shorter
+    virtual bool deflate(AsyncDeflater *deflater __attribute__((unused)), bool force __attribute__((unused)))
+    {
+      return false;
+    }
+
+    /////////////////////////////////////////////////
+
+    // Bytes sent and not acked yet
+    virtual size_t inFlight() const
+    {
+      return 0;
+    }
+
+    /////////////////////////////////////////////////
+
+    // Add the whole message to the TCP buffer without sending it, if nothing is sent yet and it fits in window
+    virtual bool addComplete(AsyncClient *client __attribute__((unused)), size_t window __attribute__((unused)))
+    {
+      return false;
+    }
 };
 
 /////////////////////////////////////////////////
@@ -282,6 +389,24 @@ class AsyncWebSocketBasicMessage: public AsyncWebSocketMessage
 
     /////////////////////////////////////////////////
 
+    virtual size_t inFlight() const override
+    {
+      return _ack - _acked;
+    }
+
+    virtual bool addComplete(AsyncClient *client, size_t window) override;
+
+    /////////////////////////////////////////////////
+
+    virtual bool canDeflate() const override
+    {
+      return _status == WS_MSG_SENDING && !_sent && _len >= WS_DEFLATE_MIN_SIZE && !(_opcode & WS_RSV1);
+    }
+
+    virtual bool deflate(AsyncDeflater *deflater, bool force) override;
+
+    /////////////////////////////////////////////////
+
     virtual void ack(size_t len, uint32_t time) override ;
     virtual size_t send(AsyncClient *client) override ;
 };
@@ -297,6 +422,7 @@ class AsyncWebSocketMultiMessage: public AsyncWebSocketMessage
     size_t _ack;
     size_t _acked;
     AsyncWebSocketMessageBuffer * _WSbuffer;
+    uint8_t * _deflated;    // Own compressed copy of the shared buffer
 
   public:
     AsyncWebSocketMultiMessage(AsyncWebSocketMessageBuffer * buffer, uint8_t opcode = WS_TEXT, bool mask = false);
@@ -311,6 +437,151 @@ class AsyncWebSocketMultiMessage: public AsyncWebSocketMessage
 
     /////////////////////////////////////////////////
 
+    virtual size_t inFlight() const override
+    {
+      return _ack - _acked;
+    }
+
+    virtual bool addComplete(AsyncClient *client, size_t window) override;
+
+    /////////////////////////////////////////////////
+
+    virtual bool canDeflate() const override
+    {
+      return _status == WS_MSG_SENDING && !_sent && _len >= WS_DEFLATE_MIN_SIZE && !(_opcode & WS_RSV1);
+    }
+
+    virtual bool deflate(AsyncDeflater *deflater, bool force) override;
+
+    /////////////////////////////////////////////////
+
+    virtual void ack(size_t len, uint32_t time) override ;
+    virtual size_t send(AsyncClient *client) override ;
+};
+
+/////////////////////////////////////////////////
+
+// Several small messages, encoded as frames when added and sent in as few TCP writes as the window allows.
+// Queue it once with client->message(batch), after adding all its messages.
+class AsyncWebSocketBatchMessage: public AsyncWebSocketMessage
+{
+  private:
+    uint8_t * _data;
+    size_t _len;
+    size_t _capacity;
+    size_t _sent;
+    size_t _frameEnd;       // End of the frame _sent is in, control frames only go in when _sent is there
+    size_t _ack;
+    size_t _acked;
+
+  public:
+    AsyncWebSocketBatchMessage(size_t reserve = 0, bool mask = false);
+    virtual ~AsyncWebSocketBatchMessage() override;
+
+    /////////////////////////////////////////////////
+
+    // Add a complete message, false without memory
+    bool add(uint8_t opcode, const uint8_t * data, size_t len);
+
+    /////////////////////////////////////////////////
+
+    inline bool text(const char * message, size_t len)
+    {
+      return add(WS_TEXT, (const uint8_t *) message, len);
+    }
+
+    /////////////////////////////////////////////////
+
+    inline bool text(const String &message)
+    {
+      return text(message.c_str(), message.length());
+    }
+
+    /////////////////////////////////////////////////
+
+    inline bool binary(const uint8_t * message, size_t len)
+    {
+      return add(WS_BINARY, message, len);
+    }
+
+    /////////////////////////////////////////////////
+
+    // Encoded size of the frames
+    inline size_t length() const
+    {
+      return _len;
+    }
+
+    /////////////////////////////////////////////////
+
+    virtual bool betweenFrames() const override
+    {
+      return _acked == _ack && _sent == _frameEnd;
+    }
+
+    /////////////////////////////////////////////////
+
+    virtual bool acked() const override
+    {
+      return _acked == _ack;
+    }
+
+    /////////////////////////////////////////////////
+
+    virtual size_t inFlight() const override
+    {
+      return _ack - _acked;
+    }
+
+    virtual bool addComplete(AsyncClient *client, size_t window) override;
+
+    /////////////////////////////////////////////////
+
+    virtual void ack(size_t len, uint32_t time) override ;
+    virtual size_t send(AsyncClient *client) override ;
+};
+
+/////////////////////////////////////////////////
+
+// A complete frame, encoded once and shared by all the clients of a broadcast (textAll(), binaryAll())
+class AsyncWebSocketFrameMessage: public AsyncWebSocketMessage
+{
+  private:
+    AsyncWebSocketMessageBuffer * _frame;
+    size_t _sent;
+    size_t _ack;
+    size_t _acked;
+
+  public:
+    AsyncWebSocketFrameMessage(AsyncWebSocketMessageBuffer * frame);
+    virtual ~AsyncWebSocketFrameMessage() override;
+
+    /////////////////////////////////////////////////
+
+    // A single frame, cut at the TCP window : nothing goes in before it is complete
+    virtual bool betweenFrames() const override
+    {
+      return _acked == _ack && (_sent == 0 || _sent == _frame->length());
+    }
+
+    /////////////////////////////////////////////////
+
+    virtual bool acked() const override
+    {
+      return _acked == _ack;
+    }
+
+    /////////////////////////////////////////////////
+
+    virtual size_t inFlight() const override
+    {
+      return _ack - _acked;
+    }
+
+    virtual bool addComplete(AsyncClient *client, size_t window) override;
+
+    /////////////////////////////////////////////////
+
     virtual void ack(size_t len, uint32_t time) override ;
     virtual size_t send(AsyncClient *client) override ;
 };
@@ -325,23 +596,37 @@ class AsyncWebSocketClient
     uint32_t _clientId;
     AwsClientStatus _status;
 
-    LinkedList<AsyncWebSocketControl *> _controlQueue;
-    LinkedList<AsyncWebSocketMessage *> _messageQueue;
+    RingQueue<AsyncWebSocketControl *, WS_MAX_QUEUED_MESSAGES> _controlQueue;
+    RingQueue<AsyncWebSocketMessage *, WS_MAX_QUEUED_MESSAGES> _messageQueue;
 
     uint8_t _pstate;
+    bool _protocolError;              // Connection failed (RFC 6455 7.1.7) : what the client sends is ignored
     AwsFrameInfo _pinfo;
 
     uint32_t _lastMessageTime;
     uint32_t _keepAlivePeriod;
+    uint32_t _corkDelay;
+    uint32_t _corkStart;
+
+    AwsDeflateParams _deflate;
+    AsyncDeflater * _deflater;        // Kept between messages with context takeover
+    uint8_t * _inflateBuffer;         // Compressed message being received
+    size_t _inflateLen;               // Above maxMessageSize once the message is refused
+    size_t _inflateCapacity;
+    uint8_t _inflateOpcode;           // WS_TEXT or WS_BINARY while receiving a compressed message, else 0
 
     void _queueMessage(AsyncWebSocketMessage *dataMessage);
     void _queueControl(AsyncWebSocketControl *controlMessage);
     void _runQueue();
+    void _sendMessages();
+    void _deflateMessage(AsyncWebSocketMessage *dataMessage);
+    void _appendDeflated(const uint8_t *data, size_t len);
+    void _inflateMessage();
 
   public:
     void *_tempObject;
 
-    AsyncWebSocketClient(AsyncWebServerRequest *request, AsyncWebSocket *server);
+    AsyncWebSocketClient(AsyncWebServerRequest *request, AsyncWebSocket *server, const AwsDeflateParams *deflate = NULL);
     ~AsyncWebSocketClient();
 
     /////////////////////////////////////////////////
@@ -382,6 +667,14 @@ class AsyncWebSocketClient
 
     /////////////////////////////////////////////////
 
+    // permessage-deflate as negotiated, windowBits 0 if not used
+    inline AwsDeflateParams const &deflateParams() const
+    {
+      return _deflate;
+    }
+
+    /////////////////////////////////////////////////
+
     IPAddress remoteIP();
     uint16_t  remotePort();
 
@@ -406,6 +699,22 @@ class AsyncWebSocketClient
 
     /////////////////////////////////////////////////
 
+    //set cork delay in ms : small messages wait that long for others, to go out in one TCP write.
+    //a task of the server sends them when the delay is over. disabled if zero (default)
+    inline void corkDelay(uint16_t ms)
+    {
+      _corkDelay = ms;
+    }
+
+    /////////////////////////////////////////////////
+
+    inline uint16_t corkDelay()
+    {
+      return (uint16_t) _corkDelay;
+    }
+
+    /////////////////////////////////////////////////
+
     //data packets
     inline void message(AsyncWebSocketMessage *message)
     {
@@ -438,12 +747,13 @@ class AsyncWebSocketClient
 
     inline bool canSend()
     {
-      return _messageQueue.length() < WS_MAX_QUEUED_MESSAGES;
+      return !_messageQueue.isFull();
     }
 
     /////////////////////////////////////////////////
 
     //system callbacks (do not call)
+    void _onCork();
     void _onAck(size_t len, uint32_t time);
     void _onError(int8_t);
     void _onPoll();
@@ -472,6 +782,16 @@ class AsyncWebSocket: public AsyncWebHandler
     AwsEventHandler _eventHandler;
     bool _enabled;
     AsyncWebLock _lock;
+    AwsDeflateParams _deflate;
+    TaskHandle_t _corkTask;           // Ends the cork delay of the clients, created on first use
+    bool _corkArmed;
+    uint32_t _corkDue;                // millis() when the earliest cork delay ends
+
+    AsyncWebSocketMessageBuffer * _makeFrame(uint8_t opcode, const uint8_t * data, size_t len, bool progmem = false);
+    AsyncWebSocketMessageBuffer * _makeDeflatedFrame(uint8_t opcode, const uint8_t * data, size_t len, bool progmem,
+                                                     uint8_t windowBits);
+    bool _acceptDeflateOffer(const String& offer, AwsDeflateParams& params, String& extension);
+    void _sendAll(uint8_t opcode, const uint8_t * data, size_t len, bool progmem = false);
 
   public:
     AsyncWebSocket(const String& url);
@@ -500,6 +820,14 @@ class AsyncWebSocket: public AsyncWebHandler
 
     /////////////////////////////////////////////////
 
+    // permessage-deflate (RFC 7692) for new connections, when the client offers it. windowBits 0 disables it (default).
+    // Each such client uses about 6 * (1 << windowBits) + 2 KB while compressing, kept between messages unless
+    // noContextTakeover, and up to 2 * maxMessageSize while decompressing a received message
+    void setCompression(uint8_t windowBits = WS_DEFLATE_WINDOW_BITS, bool noContextTakeover = false,
+                        size_t maxMessageSize = WS_DEFLATE_MAX_MESSAGE_SIZE);
+
+    /////////////////////////////////////////////////
+
     bool availableForWriteAll();
     bool availableForWrite(uint32_t id);
 
@@ -578,8 +906,18 @@ class AsyncWebSocket: public AsyncWebHandler
 
     /////////////////////////////////////////////////
 
+    // Held by every path touching the clients' queues : AsyncTCP callbacks, send calls and the cork task
+    inline const AsyncWebLock& _getLock() const
+    {
+      return _lock;
+    }
+
+    /////////////////////////////////////////////////
+
     void _addClient(AsyncWebSocketClient * client);
     void _handleDisconnect(AsyncWebSocketClient * client);
+    void _armCork(uint32_t delay);
+    uint32_t _onCorkTimer();
     void _handleEvent(AsyncWebSocketClient * client, AwsEventType type, void * arg, uint8_t *data, size_t len);
     virtual bool canHandle(AsyncWebServerRequest *request) override final;
     virtual void handleRequest(AsyncWebServerRequest *request) override final;
@@ -601,9 +939,10 @@ class AsyncWebSocketResponse: public AsyncWebServerResponse
   private:
     String _content;
     AsyncWebSocket *_server;
+    AwsDeflateParams _deflate;
 
   public:
-    AsyncWebSocketResponse(const String& key, AsyncWebSocket *server);
+    AsyncWebSocketResponse(const String& key, AsyncWebSocket *server, const AwsDeflateParams *deflate = NULL);
     void _respond(AsyncWebServerRequest *request);
     size_t _ack(AsyncWebServerRequest *request, size_t len, uint32_t time);
 
@@ -0,0 +1,108 @@
+/****************************************************************************************************************************
+  AsyncWebSocketMask.h - Dead simple Ethernet AsyncWebServer.
+
+  For LAN8720 Ethernet in WT32_ETH01 (ESP32 + LAN8720)
+
+  AsyncWebServer_WT32_ETH01 is a library for the Ethernet LAN8720 in WT32_ETH01 to run AsyncWebServer
+
+  Based on and modified from ESPAsyncWebServer (https://github.com/me-no-dev/ESPAsyncWebServer)
+  Built by Khoi Hoang https://github.com/khoih-prog/AsyncWebServer_WT32_ETH01
+  Licensed under GPLv3 license
+
+  Original author: Hristo Gochkov
+
+  Copyright (c) 2016 Hristo Gochkov. All rights reserved.
+
+  This library is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License along with this library;
+  if not, write to the Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+  Version: 1.6.2
+
+  Version Modified By   Date      Comments
+  ------- -----------  ---------- -----------
+  1.2.3   K Hoang      17/07/2021 Initial porting for WT32_ETH01 (ESP32 + LAN8720). Sync with ESPAsyncWebServer v1.2.3
+  1.2.4   K Hoang      02/08/2021 Fix Mbed TLS compile error with ESP32 core v2.0.0-rc1+
+  1.2.5   K Hoang      09/10/2021 Update `platform.ini` and `library.json`Working only with core v1.0.6-
+  1.3.0   K Hoang      23/10/2021 Making compatible with breaking core v2.0.0+
+  1.4.0   K Hoang      27/11/2021 Auto detect ESP32 core version
+  1.4.1   K Hoang      29/11/2021 Fix bug in examples to reduce connection time
+  1.5.0   K Hoang      01/10/2022 Fix AsyncWebSocket bug
+  1.6.0   K Hoang      04/10/2022 Option to use cString instead of String to save Heap
+  1.6.1   K Hoang      05/10/2022 Don't need memmove(), String no longer destroyed
+  1.6.2   K Hoang      10/11/2022 Add examples to demo how to use beginChunkedResponse() to send in chunks
+ *****************************************************************************************************************************/
+/*
+  WebSocket (un)masking, RFC 6455 5.3 : XOR of the payload with the 4 bytes key, 32 bits at a time.
+  Standalone, for host benchmarks : see utils/ws_mask_benchmark.cpp
+*/
+
+#ifndef ASYNC_WEBSOCKET_MASK_H_
+#define ASYNC_WEBSOCKET_MASK_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+namespace eth {
+
+/////////////////////////////////////////////////
+
+// Payload bytes seen as words, without breaking strict aliasing
+typedef uint32_t __attribute__((__may_alias__)) AwsMaskWord;
+
+/////////////////////////////////////////////////
+
+// XOR len bytes of data, at offset index in the frame payload, with the mask key
+static inline void webSocketMask(uint8_t* data, size_t len, const uint8_t mask[4], uint64_t index)
+{
+  // Head : bytes up to a word boundary
+  while (len && ((uintptr_t) data & 3))
+  {
+    *data++ ^= mask[index++ & 3];
+    len--;
+  }
+
+  if (len >= 4)
+  {
+    // Key rotated to the current offset, in memory order, so the same on any endianness
+    const uint8_t rotated[4] = { mask[index & 3], mask[(index + 1) & 3], mask[(index + 2) & 3], mask[(index + 3) & 3] };
+    AwsMaskWord key;
+    AwsMaskWord* words = (AwsMaskWord*) data;
+    size_t count = len >> 2;
+
+    memcpy(&key, rotated, 4);
+
+    while (count >= 4)
+    {
+      words[0] ^= key;
+      words[1] ^= key;
+      words[2] ^= key;
+      words[3] ^= key;
+      words += 4;
+      count -= 4;
+    }
+
+    while (count--)
+      *words++ ^= key;
+
+    // Whole words keep the key phase
+    data += len & ~(size_t) 3;
+    len &= 3;
+  }
+
+  // Tail
+  while (len--)
+    *data++ ^= mask[index++ & 3];
+}
+
+/////////////////////////////////////////////////
+
+}
+
+#endif    // ASYNC_WEBSOCKET_MASK_H_
@@ -335,6 +335,100 @@ class LinkedList
 /////////////////////////////////////////////////
 /////////////////////////////////////////////////
 
+// FIFO of at most N items, stored inline : O(1) add, removeFront and length, no allocation
+template <typename T, size_t N>
+class RingQueue
+{
+  private:
+    T _items[N];
+    size_t _head;
+    size_t _count;
+
+  public:
+    RingQueue() : _head(0), _count(0) {}
+
+    /////////////////////////////////////////////////
+
+    inline size_t length() const
+    {
+      return _count;
+    }
+
+    /////////////////////////////////////////////////
+
+    inline size_t capacity() const
+    {
+      return N;
+    }
+
+    /////////////////////////////////////////////////
+
+    inline bool isEmpty() const
+    {
+      return _count == 0;
+    }
+
+    /////////////////////////////////////////////////
+
+    inline bool isFull() const
+    {
+      return _count == N;
+    }
+
+    /////////////////////////////////////////////////
+
+    inline T& front()
+    {
+      return _items[_head];
+    }
+
+    /////////////////////////////////////////////////
+
+    // index-th item from the front, index < length()
+    inline T& at(size_t index)
+    {
+      index += _head;
+
+      return _items[(index >= N) ? index - N : index];
+    }
+
+    /////////////////////////////////////////////////
+
+    // false when full, the item is then left to the caller
+    bool add(const T& item)
+    {
+      if (_count == N)
+        return false;
+
+      size_t tail = _head + _count;
+
+      if (tail >= N)
+        tail -= N;
+
+      _items[tail] = item;
+      _count++;
+
+      return true;
+    }
+
+    /////////////////////////////////////////////////
+
+    T removeFront()
+    {
+      T item = _items[_head];
+
+      if (++_head == N)
+        _head = 0;
+
+      _count--;
+
+      return item;
+    }
+};
+
+/////////////////////////////////////////////////
+/////////////////////////////////////////////////
+
 class StringArray : public LinkedList<String>
 {
   public:
@@ -625,6 +625,7 @@ void SPIFFSEditor::handleRequest(AsyncWebServerRequest *request)
     if (request->hasParam("path", true))
     {
       _fs.remove(request->getParam("path", true)->value());
+      AsyncStaticWebHandler::filesChanged();
       request->send(200, "", "DELETE: " + request->getParam("path", true)->value());
     }
     else
@@ -655,6 +656,7 @@ void SPIFFSEditor::handleRequest(AsyncWebServerRequest *request)
         {
           f.write((uint8_t)0x00);
           f.close();
+          AsyncStaticWebHandler::filesChanged();
           request->send(200, "", "CREATE: " + filename);
         }
         else
@@ -680,6 +682,7 @@ void SPIFFSEditor::handleUpload(AsyncWebServerRequest *request, const String& fi
       _authenticated = true;
       request->_tempFile = _fs.open(filename, "w");
       _startTime = millis();
+      AsyncStaticWebHandler::filesChanged();
     }
   }
 
@@ -693,6 +696,7 @@ void SPIFFSEditor::handleUpload(AsyncWebServerRequest *request, const String& fi
     if (final)
     {
       request->_tempFile.close();
+      AsyncStaticWebHandler::filesChanged();
     }
   }
 }
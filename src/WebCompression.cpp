@@ -0,0 +1,924 @@
+/****************************************************************************************************************************
+  WebCompression.cpp - Dead simple Ethernet AsyncWebServer.
+
+  For LAN8720 Ethernet in WT32_ETH01 (ESP32 + LAN8720)
+
+  AsyncWebServer_WT32_ETH01 is a library for the Ethernet LAN8720 in WT32_ETH01 to run AsyncWebServer
+
+  Based on and modified from ESPAsyncWebServer (https://github.com/me-no-dev/ESPAsyncWebServer)
+  Built by Khoi Hoang https://github.com/khoih-prog/AsyncWebServer_WT32_ETH01
+  Licensed under GPLv3 license
+
+  Original author: Hristo Gochkov
+
+  Copyright (c) 2016 Hristo Gochkov. All rights reserved.
+
+  This library is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License along with this library;
+  if not, write to the Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+  Version: 1.6.2
+
+  Version Modified By   Date      Comments
+  ------- -----------  ---------- -----------
+  1.2.3   K Hoang      17/07/2021 Initial porting for WT32_ETH01 (ESP32 + LAN8720). Sync with ESPAsyncWebServer v1.2.3
+  1.2.4   K Hoang      02/08/2021 Fix Mbed TLS compile error with ESP32 core v2.0.0-rc1+
+  1.2.5   K Hoang      09/10/2021 Update `platform.ini` and `library.json`Working only with core v1.0.6-
+  1.3.0   K Hoang      23/10/2021 Making compatible with breaking core v2.0.0+
+  1.4.0   K Hoang      27/11/2021 Auto detect ESP32 core version
+  1.4.1   K Hoang      29/11/2021 Fix bug in examples to reduce connection time
+  1.5.0   K Hoang      01/10/2022 Fix AsyncWebSocket bug
+  1.6.0   K Hoang      04/10/2022 Option to use cString instead of String to save Heap
+  1.6.1   K Hoang      05/10/2022 Don't need memmove(), String no longer destroyed
+  1.6.2   K Hoang      10/11/2022 Add examples to demo how to use beginChunkedResponse() to send in chunks
+ *****************************************************************************************************************************/
+
+#include "WebCompression.h"
+
+namespace eth {
+
+/////////////////////////////////////////////////
+
+#define DEFLATE_HASH_BITS       10
+#define DEFLATE_HASH_SIZE       (1 << DEFLATE_HASH_BITS)
+#define DEFLATE_MIN_MATCH       3
+#define DEFLATE_MAX_MATCH       258
+#define DEFLATE_LOOKAHEAD       (DEFLATE_MAX_MATCH + DEFLATE_MIN_MATCH)
+
+/////////////////////////////////////////////////
+
+static const uint16_t lengthBase[] =
+{
+  3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+
+static const uint8_t lengthExtra[] =
+{
+  0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+
+static const uint16_t distanceBase[] =
+{
+  1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073,
+  4097, 6145, 8193, 12289, 16385, 24577
+};
+
+static const uint8_t distanceExtra[] =
+{
+  0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+// CRC32 (reflected 0xEDB88320), one nibble at a time to keep the table small
+static const uint32_t crcTable[16] =
+{
+  0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+  0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+
+/////////////////////////////////////////////////
+
+static inline uint32_t deflateHash(const uint8_t* p)
+{
+  const uint32_t value = ((uint32_t) p[0] << 16) | ((uint32_t) p[1] << 8) | p[2];
+
+  return (uint32_t) (value * 2654435761U) >> (32 - DEFLATE_HASH_BITS);
+}
+
+/////////////////////////////////////////////////
+
+AsyncDeflater::AsyncDeflater(AwsContentEncoding encoding, size_t windowSize)
+  : _encoding(encoding), _windowSize(1024), _window(nullptr), _hashHead(nullptr), _hashPrev(nullptr), _pos(0), _end(0),
+    _out(nullptr), _outCapacity(0), _outStart(0), _outEnd(0), _bitBuf(0), _bitCount(0),
+    _checksum(encoding == AWS_ENCODING_GZIP ? 0 : 1), _totalIn(0), _finished(false)
+{
+  // Largest power of 2 not above the requested size. Positions (+ 1) in 2 * window must fit in uint16_t
+  while (_windowSize < 16384 && (_windowSize << 1) <= windowSize)
+    _windowSize <<= 1;
+
+  // One commit() processes at most _windowSize + DEFLATE_LOOKAHEAD bytes, 9 bits per byte in the worst case
+  _outCapacity = _windowSize + (_windowSize >> 1) + 64;
+
+  _window   = (uint8_t*) malloc(_windowSize << 1);
+  _hashHead = (uint16_t*) calloc(DEFLATE_HASH_SIZE, sizeof(uint16_t));
+  _hashPrev = (uint16_t*) calloc(_windowSize, sizeof(uint16_t));
+  _out      = (uint8_t*) malloc(_outCapacity);
+
+  if (!valid())
+  {
+    AWS_LOGERROR1(F("[AsyncDeflater] malloc failed, window ="), _windowSize);
+
+    return;
+  }
+
+  if (_encoding == AWS_ENCODING_GZIP)
+  {
+    static const uint8_t gzipHeader[10] = { 0x1F, 0x8B, 0x08, 0, 0, 0, 0, 0, 0, 0xFF };
+
+    memcpy(_out, gzipHeader, sizeof(gzipHeader));
+    _outEnd = sizeof(gzipHeader);
+  }
+  else if (_encoding == AWS_ENCODING_DEFLATE)
+  {
+    uint8_t cmf = 0x08 | ((__builtin_ctz(_windowSize) - 8) << 4);
+    uint8_t flg = 31 - ((cmf << 8) % 31);
+
+    _putByte(cmf);
+    _putByte(flg == 31 ? 0 : flg);
+  }
+
+  // Everything goes into one fixed Huffman block, not final : BFINAL = 0, BTYPE = 01
+  _putBits(0, 1);
+  _putBits(1, 2);
+}
+
+/////////////////////////////////////////////////
+
+AsyncDeflater::~AsyncDeflater()
+{
+  free(_window);
+  free(_hashHead);
+  free(_hashPrev);
+  free(_out);
+}
+
+/////////////////////////////////////////////////
+
+void AsyncDeflater::_putByte(uint8_t value)
+{
+  if (_outEnd < _outCapacity)
+    _out[_outEnd++] = value;
+}
+
+/////////////////////////////////////////////////
+
+void AsyncDeflater::_putBits(uint32_t value, uint8_t count)
+{
+  _bitBuf |= value << _bitCount;
+  _bitCount += count;
+
+  while (_bitCount >= 8)
+  {
+    _putByte(_bitBuf & 0xFF);
+    _bitBuf >>= 8;
+    _bitCount -= 8;
+  }
+}
+
+/////////////////////////////////////////////////
+
+// Huffman codes are stored most significant bit first
+void AsyncDeflater::_putCode(uint16_t code, uint8_t count)
+{
+  uint16_t reversed = 0;
+
+  for (uint8_t i = 0; i < count; i++)
+  {
+    reversed = (reversed << 1) | (code & 1);
+    code >>= 1;
+  }
+
+  _putBits(reversed, count);
+}
+
+/////////////////////////////////////////////////
+
+void AsyncDeflater::_alignToByte()
+{
+  if (_bitCount)
+    _putBits(0, 8 - _bitCount);
+}
+
+/////////////////////////////////////////////////
+
+void AsyncDeflater::_putLiteral(uint8_t value)
+{
+  if (value < 144)
+    _putCode(0x30 + value, 8);
+  else
+    _putCode(0x190 + value - 144, 9);
+}
+
+/////////////////////////////////////////////////
+
+void AsyncDeflater::_putMatch(size_t length, size_t distance)
+{
+  uint8_t code = 0;
+
+  while (code < 28 && lengthBase[code + 1] <= length)
+    code++;
+
+  // Length symbols 257 - 279 use 7 bits, 280 - 287 use 8 bits
+  if (code < 23)
+    _putCode(code + 1, 7);
+  else
+    _putCode(0xC0 + code - 23, 8);
+
+  if (lengthExtra[code])
+    _putBits(length - lengthBase[code], lengthExtra[code]);
+
+  code = 0;
+
+  while (code < 29 && distanceBase[code + 1] <= distance)
+    code++;
+
+  _putCode(code, 5);
+
+  if (distanceExtra[code])
+    _putBits(distance - distanceBase[code], distanceExtra[code]);
+}
+
+/////////////////////////////////////////////////
+
+void AsyncDeflater::_updateChecksum(const uint8_t* data, size_t len)
+{
+  if (_encoding == AWS_ENCODING_GZIP)
+  {
+    uint32_t crc = ~_checksum;
+
+    while (len--)
+    {
+      crc ^= *data++;
+      crc = (crc >> 4) ^ crcTable[crc & 0x0F];
+      crc = (crc >> 4) ^ crcTable[crc & 0x0F];
+    }
+
+    _checksum = ~crc;
+  }
+  else
+  {
+    uint32_t s1 = _checksum & 0xFFFF;
+    uint32_t s2 = _checksum >> 16;
+
+    while (len--)
+    {
+      s1 += *data++;
+
+      if (s1 >= 65521)
+        s1 -= 65521;
+
+      s2 += s1;
+
+      if (s2 >= 65521)
+        s2 -= 65521;
+    }
+
+    _checksum = (s2 << 16) | s1;
+  }
+}
+
+/////////////////////////////////////////////////
+
+void AsyncDeflater::_insertHash(size_t pos)
+{
+  uint32_t hash = deflateHash(_window + pos);
+
+  _hashPrev[pos & (_windowSize - 1)] = _hashHead[hash];
+  _hashHead[hash] = pos + 1;
+}
+
+/////////////////////////////////////////////////
+
+size_t AsyncDeflater::_findMatch(size_t pos, size_t& distance)
+{
+  const size_t maxLen = (_end - pos < DEFLATE_MAX_MATCH) ? _end - pos : DEFLATE_MAX_MATCH;
+  size_t bestLen = 0;
+  uint16_t candidate = _hashHead[deflateHash(_window + pos)];
+  uint8_t chain = DEFLATE_MAX_CHAIN;
+
+  while (candidate && chain--)
+  {
+    const size_t match = candidate - 1;
+
+    if (match >= pos || pos - match >= _windowSize)
+      break;
+
+    if (_window[match + bestLen] == _window[pos + bestLen])
+    {
+      size_t len = 0;
+
+      while (len < maxLen && _window[match + len] == _window[pos + len])
+        len++;
+
+      if (len > bestLen)
+      {
+        bestLen = len;
+        distance = pos - match;
+
+        if (len == maxLen)
+          break;
+      }
+    }
+
+    const uint16_t next = _hashPrev[match & (_windowSize - 1)];
+
+    // Entry overwritten by a newer position : the chain ends here
+    if (next >= candidate)
+      break;
+
+    candidate = next;
+  }
+
+  return bestLen;
+}
+
+/////////////////////////////////////////////////
+
+// Drop the oldest _windowSize bytes, positions in the hash tables move accordingly
+void AsyncDeflater::_slide()
+{
+  memmove(_window, _window + _windowSize, _end - _windowSize);
+  _pos -= _windowSize;
+  _end -= _windowSize;
+
+  for (size_t i = 0; i < DEFLATE_HASH_SIZE; i++)
+    _hashHead[i] = (_hashHead[i] > _windowSize) ? _hashHead[i] - _windowSize : 0;
+
+  for (size_t i = 0; i < _windowSize; i++)
+    _hashPrev[i] = (_hashPrev[i] > _windowSize) ? _hashPrev[i] - _windowSize : 0;
+}
+
+/////////////////////////////////////////////////
+
+void AsyncDeflater::_compress(bool flush)
+{
+  while (_pos < _end)
+  {
+    const size_t available = _end - _pos;
+
+    // Keep enough lookahead for a full match, unless this is the end of input
+    if (!flush && available < DEFLATE_LOOKAHEAD)
+      break;
+
+    size_t distance = 0;
+    size_t len = 0;
+
+    if (available >= DEFLATE_MIN_MATCH)
+    {
+      len = _findMatch(_pos, distance);
+      _insertHash(_pos);
+    }
+
+    if (len >= DEFLATE_MIN_MATCH)
+    {
+      _putMatch(len, distance);
+
+      for (size_t i = 1; i < len; i++)
+      {
+        if (_pos + i + DEFLATE_MIN_MATCH <= _end)
+          _insertHash(_pos + i);
+      }
+
+      _pos += len;
+    }
+    else
+    {
+      _putLiteral(_window[_pos++]);
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+
+uint8_t* AsyncDeflater::inputBuffer(size_t& space)
+{
+  // Output of the previous commit must be read first
+  if (!valid() || _finished || pending())
+  {
+    space = 0;
+
+    return nullptr;
+  }
+
+  if (_pos >= _windowSize)
+    _slide();
+
+  space = (_windowSize << 1) - _end;
+
+  if (space > _windowSize)
+    space = _windowSize;
+
+  return _window + _end;
+}
+
+/////////////////////////////////////////////////
+
+void AsyncDeflater::commit(size_t len)
+{
+  if (!valid() || _finished || !len)
+    return;
+
+  if (_encoding != AWS_ENCODING_RAW)
+    _updateChecksum(_window + _end, len);
+
+  _totalIn += len;
+  _end += len;
+
+  _compress(false);
+}
+
+/////////////////////////////////////////////////
+
+void AsyncDeflater::flush()
+{
+  if (!valid() || _finished)
+    return;
+
+  if (_outStart)
+  {
+    memmove(_out, _out + _outStart, pending());
+    _outEnd -= _outStart;
+    _outStart = 0;
+  }
+
+  _compress(true);
+
+  // End of block, then an empty stored block : BFINAL = 0, BTYPE = 00, LEN = 0, NLEN = 0xFFFF
+  _putCode(0, 7);
+  _putBits(0, 3);
+  _alignToByte();
+  _putByte(0x00);
+  _putByte(0x00);
+  _putByte(0xFF);
+  _putByte(0xFF);
+
+  // Header of the next fixed Huffman block, written out with the next input
+  _putBits(0, 1);
+  _putBits(1, 2);
+}
+
+/////////////////////////////////////////////////
+
+void AsyncDeflater::finish()
+{
+  if (!valid() || _finished)
+    return;
+
+  if (_outStart)
+  {
+    memmove(_out, _out + _outStart, pending());
+    _outEnd -= _outStart;
+    _outStart = 0;
+  }
+
+  _compress(true);
+
+  // End of block, then an empty final fixed block
+  _putCode(0, 7);
+  _putBits(1, 1);
+  _putBits(1, 2);
+  _putCode(0, 7);
+  _alignToByte();
+
+  if (_encoding == AWS_ENCODING_GZIP)
+  {
+    for (uint8_t i = 0; i < 4; i++)
+      _putByte(_checksum >> (8 * i));
+
+    for (uint8_t i = 0; i < 4; i++)
+      _putByte(_totalIn >> (8 * i));
+  }
+  else if (_encoding == AWS_ENCODING_DEFLATE)
+  {
+    for (int8_t i = 3; i >= 0; i--)
+      _putByte(_checksum >> (8 * i));
+  }
+
+  _finished = true;
+}
+
+/////////////////////////////////////////////////
+
+size_t AsyncDeflater::read(uint8_t* data, size_t len)
+{
+  const size_t readLen = (len < pending()) ? len : pending();
+
+  memcpy(data, _out + _outStart, readLen);
+  _outStart += readLen;
+
+  if (_outStart == _outEnd)
+    _outStart = _outEnd = 0;
+
+  return readLen;
+}
+
+/////////////////////////////////////////////////
+/////////////////////////////////////////////////
+
+/*
+   AsyncInflater, after zlib's contrib/puff : codes are decoded bit by bit with canonical tables
+*/
+
+AsyncInflater::AsyncInflater(size_t maxLength)
+  : _in(nullptr), _inLen(0), _inPos(0), _bitBuf(0), _bitCount(0), _overrun(false),
+    _out(nullptr), _outLen(0), _outCapacity(0), _maxLength(maxLength), _overflow(false)
+{
+}
+
+/////////////////////////////////////////////////
+
+AsyncInflater::~AsyncInflater()
+{
+  free(_out);
+}
+
+/////////////////////////////////////////////////
+
+uint32_t AsyncInflater::_bits(uint8_t count)
+{
+  while (_bitCount < count)
+  {
+    if (_inPos == _inLen)
+    {
+      _overrun = true;
+
+      return 0;
+    }
+
+    _bitBuf |= (uint32_t) _in[_inPos++] << _bitCount;
+    _bitCount += 8;
+  }
+
+  const uint32_t value = _bitBuf & ((1UL << count) - 1);
+
+  _bitBuf >>= count;
+  _bitCount -= count;
+
+  return value;
+}
+
+/////////////////////////////////////////////////
+
+int AsyncInflater::_decode(const AwsHuffmanTable& table)
+{
+  int code = 0;
+  int first = 0;
+  int index = 0;
+
+  for (uint8_t len = 1; len < 16; len++)
+  {
+    code |= _bits(1);
+
+    const int count = table.count[len];
+
+    if (code - count < first)
+      return table.symbol[index + (code - first)];
+
+    index += count;
+    first = (first + count) << 1;
+    code <<= 1;
+  }
+
+  return -1;
+}
+
+/////////////////////////////////////////////////
+
+// 0 for a complete code, > 0 incomplete, < 0 over-subscribed
+int AsyncInflater::_buildTable(AwsHuffmanTable& table, const uint8_t* lengths, size_t count)
+{
+  uint16_t offsets[16];
+
+  memset(table.count, 0, sizeof(table.count));
+
+  for (size_t symbol = 0; symbol < count; symbol++)
+    table.count[lengths[symbol]]++;
+
+  if (table.count[0] == count)
+    return 0;
+
+  int left = 1;
+
+  for (uint8_t len = 1; len < 16; len++)
+  {
+    left = (left << 1) - table.count[len];
+
+    if (left < 0)
+      return left;
+  }
+
+  offsets[1] = 0;
+
+  for (uint8_t len = 1; len < 15; len++)
+    offsets[len + 1] = offsets[len] + table.count[len];
+
+  for (size_t symbol = 0; symbol < count; symbol++)
+  {
+    if (lengths[symbol])
+      table.symbol[offsets[lengths[symbol]]++] = symbol;
+  }
+
+  return left;
+}
+
+/////////////////////////////////////////////////
+
+bool AsyncInflater::_reserve(size_t len)
+{
+  if (_outLen + len > _maxLength)
+  {
+    _overflow = true;
+
+    return false;
+  }
+
+  // One spare byte for a terminating 0
+  if (_outLen + len + 1 > _outCapacity)
+  {
+    size_t capacity = _outCapacity ? _outCapacity << 1 : 256;
+
+    while (capacity < _outLen + len + 1)
+      capacity <<= 1;
+
+    if (capacity > _maxLength + 1)
+      capacity = _maxLength + 1;
+
+    uint8_t* out = (uint8_t*) realloc(_out, capacity);
+
+    if (!out)
+    {
+      AWS_LOGERROR1(F("[AsyncInflater] realloc failed, size ="), capacity);
+
+      return false;
+    }
+
+    _out = out;
+    _outCapacity = capacity;
+  }
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+
+bool AsyncInflater::_put(const uint8_t* data, size_t len)
+{
+  if (!_reserve(len))
+    return false;
+
+  memcpy(_out + _outLen, data, len);
+  _outLen += len;
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+
+// Source and destination overlap when distance < len : byte by byte
+bool AsyncInflater::_copy(size_t distance, size_t len)
+{
+  if (!_reserve(len))
+    return false;
+
+  const uint8_t* from = _out + _outLen - distance;
+  uint8_t* to = _out + _outLen;
+
+  for (size_t i = 0; i < len; i++)
+    to[i] = from[i];
+
+  _outLen += len;
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+
+bool AsyncInflater::_stored()
+{
+  _bitBuf = 0;
+  _bitCount = 0;
+
+  if (_inLen - _inPos < 4)
+  {
+    _overrun = true;
+
+    return false;
+  }
+
+  const size_t len = _in[_inPos] | ((size_t) _in[_inPos + 1] << 8);
+  const size_t nlen = _in[_inPos + 2] | ((size_t) _in[_inPos + 3] << 8);
+
+  _inPos += 4;
+
+  if (len != (~nlen & 0xFFFF) || _inLen - _inPos < len)
+    return false;
+
+  if (!_put(_in + _inPos, len))
+    return false;
+
+  _inPos += len;
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+
+bool AsyncInflater::_codes()
+{
+  while (true)
+  {
+    int symbol = _decode(_lengthCodes);
+
+    if (symbol < 0 || _overrun)
+      return false;
+
+    if (symbol < 256)
+    {
+      const uint8_t literal = symbol;
+
+      if (!_put(&literal, 1))
+        return false;
+
+      continue;
+    }
+
+    if (symbol == 256)
+      return true;
+
+    symbol -= 257;
+
+    if (symbol >= 29)
+      return false;
+
+    const size_t len = lengthBase[symbol] + _bits(lengthExtra[symbol]);
+
+    symbol = _decode(_distanceCodes);
+
+    if (symbol < 0 || symbol >= 30)
+      return false;
+
+    const size_t distance = distanceBase[symbol] + _bits(distanceExtra[symbol]);
+
+    if (_overrun || distance > _outLen)
+      return false;
+
+    if (!_copy(distance, len))
+      return false;
+  }
+}
+
+/////////////////////////////////////////////////
+
+bool AsyncInflater::_fixed()
+{
+  uint8_t lengths[288];
+
+  memset(lengths, 8, 144);
+  memset(lengths + 144, 9, 112);
+  memset(lengths + 256, 7, 24);
+  memset(lengths + 280, 8, 8);
+
+  _buildTable(_lengthCodes, lengths, 288);
+
+  memset(lengths, 5, 30);
+
+  _buildTable(_distanceCodes, lengths, 30);
+
+  return _codes();
+}
+
+/////////////////////////////////////////////////
+
+bool AsyncInflater::_dynamic()
+{
+  static const uint8_t order[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+  uint8_t lengths[286 + 30];
+
+  const size_t lengthCount = _bits(5) + 257;
+  const size_t distanceCount = _bits(5) + 1;
+  const size_t codeCount = _bits(4) + 4;
+
+  if (_overrun || lengthCount > 286 || distanceCount > 30)
+    return false;
+
+  memset(lengths, 0, 19);
+
+  for (size_t i = 0; i < codeCount; i++)
+    lengths[order[i]] = _bits(3);
+
+  if (_buildTable(_lengthCodes, lengths, 19) != 0)
+    return false;
+
+  size_t index = 0;
+
+  while (index < lengthCount + distanceCount)
+  {
+    int symbol = _decode(_lengthCodes);
+
+    if (symbol < 0 || _overrun)
+      return false;
+
+    if (symbol < 16)
+    {
+      lengths[index++] = symbol;
+
+      continue;
+    }
+
+    uint8_t value = 0;
+    size_t repeat;
+
+    if (symbol == 16)
+    {
+      if (!index)
+        return false;
+
+      value = lengths[index - 1];
+      repeat = 3 + _bits(2);
+    }
+    else if (symbol == 17)
+      repeat = 3 + _bits(3);
+    else
+      repeat = 11 + _bits(7);
+
+    if (index + repeat > lengthCount + distanceCount)
+      return false;
+
+    while (repeat--)
+      lengths[index++] = value;
+  }
+
+  // End of block code required
+  if (!lengths[256])
+    return false;
+
+  int left = _buildTable(_lengthCodes, lengths, lengthCount);
+
+  // Only a single code of length 1 may be incomplete
+  if (left < 0 || (left > 0 && lengthCount - _lengthCodes.count[0] != 1))
+    return false;
+
+  left = _buildTable(_distanceCodes, lengths + lengthCount, distanceCount);
+
+  if (left < 0 || (left > 0 && distanceCount - _distanceCodes.count[0] != 1))
+    return false;
+
+  return _codes();
+}
+
+/////////////////////////////////////////////////
+
+bool AsyncInflater::inflate(const uint8_t* data, size_t len)
+{
+  _in = data;
+  _inLen = len;
+  _inPos = 0;
+  _bitBuf = 0;
+  _bitCount = 0;
+  _overrun = false;
+  _overflow = false;
+  _outLen = 0;
+
+  bool last = false;
+
+  // End of input between blocks, after a sync flush, is a complete message too
+  while (!last && (_inPos < _inLen || _bitCount >= 3))
+  {
+    last = _bits(1);
+
+    bool valid;
+
+    switch (_bits(2))
+    {
+      case 0:
+        valid = _stored();
+        break;
+
+      case 1:
+        valid = _fixed();
+        break;
+
+      case 2:
+        valid = _dynamic();
+        break;
+
+      default:
+        valid = false;
+        break;
+    }
+
+    if (!valid || _overrun)
+    {
+      AWS_LOGDEBUG1(F("[AsyncInflater] invalid data at"), _inPos);
+
+      return false;
+    }
+  }
+
+  // A terminating 0, as for the other received data
+  if (!_reserve(0))
+    return false;
+
+  _out[_outLen] = 0;
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+
+}
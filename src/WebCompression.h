@@ -0,0 +1,251 @@
+/****************************************************************************************************************************
+  WebCompression.h - Dead simple Ethernet AsyncWebServer.
+
+  For LAN8720 Ethernet in WT32_ETH01 (ESP32 + LAN8720)
+
+  AsyncWebServer_WT32_ETH01 is a library for the Ethernet LAN8720 in WT32_ETH01 to run AsyncWebServer
+
+  Based on and modified from ESPAsyncWebServer (https://github.com/me-no-dev/ESPAsyncWebServer)
+  Built by Khoi Hoang https://github.com/khoih-prog/AsyncWebServer_WT32_ETH01
+  Licensed under GPLv3 license
+
+  Original author: Hristo Gochkov
+
+  Copyright (c) 2016 Hristo Gochkov. All rights reserved.
+
+  This library is free software; you can redistribute it and/or modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public License along with this library;
+  if not, write to the Free Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+  Version: 1.6.2
+
+  Version Modified By   Date      Comments
+  ------- -----------  ---------- -----------
+  1.2.3   K Hoang      17/07/2021 Initial porting for WT32_ETH01 (ESP32 + LAN8720). Sync with ESPAsyncWebServer v1.2.3
+  1.2.4   K Hoang      02/08/2021 Fix Mbed TLS compile error with ESP32 core v2.0.0-rc1+
+  1.2.5   K Hoang      09/10/2021 Update `platform.ini` and `library.json`Working only with core v1.0.6-
+  1.3.0   K Hoang      23/10/2021 Making compatible with breaking core v2.0.0+
+  1.4.0   K Hoang      27/11/2021 Auto detect ESP32 core version
+  1.4.1   K Hoang      29/11/2021 Fix bug in examples to reduce connection time
+  1.5.0   K Hoang      01/10/2022 Fix AsyncWebSocket bug
+  1.6.0   K Hoang      04/10/2022 Option to use cString instead of String to save Heap
+  1.6.1   K Hoang      05/10/2022 Don't need memmove(), String no longer destroyed
+  1.6.2   K Hoang      10/11/2022 Add examples to demo how to use beginChunkedResponse() to send in chunks
+ *****************************************************************************************************************************/
+
+#ifndef WEB_COMPRESSION_H_
+#define WEB_COMPRESSION_H_
+
+#include "Arduino.h"
+
+#include "AsyncWebServer_WT32_ETH01_Debug.h"
+
+/////////////////////////////////////////////////
+
+// Default history window of the streaming compressor. Must be a power of 2, 1024 to 16384.
+// Memory used per compressed response is about 6 * window + 2 KB
+#ifndef DEFLATE_WINDOW_SIZE
+  #define DEFLATE_WINDOW_SIZE         2048
+#endif
+
+// Max number of previous matches searched for each byte. Higher is slower but compresses better
+#ifndef DEFLATE_MAX_CHAIN
+  #define DEFLATE_MAX_CHAIN           16
+#endif
+
+namespace eth {
+
+/////////////////////////////////////////////////
+
+typedef enum
+{
+  AWS_ENCODING_GZIP,      // RFC 1952
+  AWS_ENCODING_DEFLATE,   // RFC 1950 (zlib), what HTTP calls "deflate"
+  AWS_ENCODING_RAW        // RFC 1951 alone, for WebSocket permessage-deflate (RFC 7692)
+} AwsContentEncoding;
+
+/////////////////////////////////////////////////
+
+/*
+   AsyncDeflater :: Streaming LZ77 + fixed Huffman (RFC 1951) compressor with a small window
+
+   Input is written straight into the window through inputBuffer() / commit(), compressed output is
+   drained with read(). Output produced by one commit() always fits in the internal buffer, provided
+   the previous output has been fully read.
+ * */
+
+class AsyncDeflater
+{
+  private:
+    AwsContentEncoding _encoding;
+    size_t _windowSize;
+    uint8_t* _window;       // 2 * _windowSize : history then lookahead
+    uint16_t* _hashHead;    // Last position (+ 1) for each hash, 0 if none
+    uint16_t* _hashPrev;    // Previous position (+ 1) with the same hash, indexed by position & (_windowSize - 1)
+    size_t _pos;            // Next byte to compress
+    size_t _end;            // End of input in _window
+
+    uint8_t* _out;
+    size_t _outCapacity;
+    size_t _outStart;
+    size_t _outEnd;
+    uint32_t _bitBuf;
+    uint8_t _bitCount;
+
+    uint32_t _checksum;     // CRC32 for gzip, Adler-32 for zlib
+    uint32_t _totalIn;
+    bool _finished;
+
+    void _putBits(uint32_t value, uint8_t count);
+    void _putCode(uint16_t code, uint8_t count);
+    void _putByte(uint8_t value);
+    void _alignToByte();
+    void _putLiteral(uint8_t value);
+    void _putMatch(size_t length, size_t distance);
+    void _updateChecksum(const uint8_t* data, size_t len);
+    void _insertHash(size_t pos);
+    size_t _findMatch(size_t pos, size_t& distance);
+    void _slide();
+    void _compress(bool flush);
+
+  public:
+    AsyncDeflater(AwsContentEncoding encoding, size_t windowSize = DEFLATE_WINDOW_SIZE);
+    ~AsyncDeflater();
+
+    AsyncDeflater(const AsyncDeflater &) = delete;
+    AsyncDeflater &operator=(const AsyncDeflater &) = delete;
+
+    /////////////////////////////////////////////////
+
+    // False if buffers could not be allocated
+    inline bool valid() const
+    {
+      return _window && _hashHead && _hashPrev && _out;
+    }
+
+    /////////////////////////////////////////////////
+
+    // Compressed bytes waiting to be read
+    inline size_t pending() const
+    {
+      return _outEnd - _outStart;
+    }
+
+    /////////////////////////////////////////////////
+
+    // End of stream written and fully read
+    inline bool finished() const
+    {
+      return _finished && !pending();
+    }
+
+    /////////////////////////////////////////////////
+
+    // Where to write up to space bytes of input, then call commit()
+    uint8_t* inputBuffer(size_t& space);
+
+    // Compress len bytes written into inputBuffer()
+    void commit(size_t len);
+
+    // Compress all input, then end the block with an empty stored block (00 00 FF FF) : the output so far
+    // can be decoded entirely. The history is kept, later input may still refer to it
+    void flush();
+
+    // Flush remaining input and write the end of stream
+    void finish();
+
+    // Move up to len compressed bytes into data. Returns bytes read.
+    size_t read(uint8_t* data, size_t len);
+};
+
+/////////////////////////////////////////////////
+
+typedef struct
+{
+  uint16_t count[16];     // Number of codes of each length
+  uint16_t symbol[288];   // Symbols ordered by code
+} AwsHuffmanTable;
+
+/////////////////////////////////////////////////
+
+/*
+   AsyncInflater :: RFC 1951 decoder of a complete input, into one buffer grown up to maxLength
+
+   The output is its own history : data compressed with a dictionary from previous messages can't be decoded.
+   Decoding stops at the final block, or at the end of input between two blocks.
+ * */
+
+class AsyncInflater
+{
+  private:
+    const uint8_t* _in;
+    size_t _inLen;
+    size_t _inPos;
+    uint32_t _bitBuf;
+    uint8_t _bitCount;
+    bool _overrun;
+
+    uint8_t* _out;
+    size_t _outLen;
+    size_t _outCapacity;
+    size_t _maxLength;
+    bool _overflow;
+
+    AwsHuffmanTable _lengthCodes;
+    AwsHuffmanTable _distanceCodes;
+
+    uint32_t _bits(uint8_t count);
+    int _decode(const AwsHuffmanTable& table);
+    int _buildTable(AwsHuffmanTable& table, const uint8_t* lengths, size_t count);
+    bool _reserve(size_t len);
+    bool _put(const uint8_t* data, size_t len);
+    bool _copy(size_t distance, size_t len);
+    bool _stored();
+    bool _fixed();
+    bool _dynamic();
+    bool _codes();
+
+  public:
+    AsyncInflater(size_t maxLength);
+    ~AsyncInflater();
+
+    AsyncInflater(const AsyncInflater &) = delete;
+    AsyncInflater &operator=(const AsyncInflater &) = delete;
+
+    // False on invalid data, or when the output would be longer than maxLength
+    bool inflate(const uint8_t* data, size_t len);
+
+    /////////////////////////////////////////////////
+
+    // Decoded data, followed by one spare byte
+    inline uint8_t* data()
+    {
+      return _out;
+    }
+
+    /////////////////////////////////////////////////
+
+    inline size_t length() const
+    {
+      return _outLen;
+    }
+
+    /////////////////////////////////////////////////
+
+    // inflate() failed on maxLength rather than on invalid data
+    inline bool overflow() const
+    {
+      return _overflow;
+    }
+};
+
+/////////////////////////////////////////////////
+
+}
+
+#endif    // WEB_COMPRESSION_H_
@@ -56,6 +56,71 @@ namespace eth {
 
 /////////////////////////////////////////////////
 
+// Number of ETags remembered by each AsyncStaticWebHandler
+#ifndef STATIC_ETAG_CACHE_SIZE
+  #define STATIC_ETAG_CACHE_SIZE          8
+#endif
+
+// Files up to this size get a strong ETag, hashed from their content in one go on the AsyncTCP task
+// the first time they are served. Larger files get a weak ETag (W/) from path, size and last write
+// time only, which can't validate If-Range (last write time is 0 on SPIFFS)
+#ifndef STATIC_ETAG_HASH_MAX_SIZE
+  #define STATIC_ETAG_HASH_MAX_SIZE       16384
+#endif
+
+// Largest file kept in RAM by AsyncStaticWebHandler::setCache()
+#ifndef STATIC_CACHE_MAX_FILE_SIZE
+  #define STATIC_CACHE_MAX_FILE_SIZE      8192
+#endif
+
+// A file served from RAM is checked again against the FS (size, last write) after this delay, in ms
+#ifndef STATIC_CACHE_CHECK_INTERVAL
+  #define STATIC_CACHE_CHECK_INTERVAL     2000
+#endif
+
+// Number of URL to file resolutions remembered by each AsyncStaticWebHandler
+#ifndef STATIC_RESOLVE_CACHE_SIZE
+  #define STATIC_RESOLVE_CACHE_SIZE       16
+#endif
+
+// URLs found missing are answered without FS access for this long, in ms, unless files change before
+#ifndef STATIC_RESOLVE_NEGATIVE_TTL
+  #define STATIC_RESOLVE_NEGATIVE_TTL     5000
+#endif
+
+// RAM used by the rendered responses of each AsyncCallbackWebHandler::setCache(), heads included
+#ifndef RESPONSE_CACHE_BUDGET
+  #define RESPONSE_CACHE_BUDGET           8192
+#endif
+
+// Larger rendered responses are sent but not kept
+#ifndef RESPONSE_CACHE_MAX_SIZE
+  #define RESPONSE_CACHE_MAX_SIZE         4096
+#endif
+
+/////////////////////////////////////////////////
+
+typedef struct
+{
+  String path;
+  size_t size;
+  time_t lastWrite;
+  String etag;
+} AwsETagEntry;
+
+/////////////////////////////////////////////////
+
+typedef struct
+{
+  String url;
+  uint8_t accept;       // AWS_ACCEPT_* of the request
+  String path;          // FS path the URL resolves to, empty if nothing was found
+  String variant;       // FS path opened : path, path.gz or path.br
+  uint32_t storedAt;    // millis()
+} AwsResolveEntry;
+
+/////////////////////////////////////////////////
+
 class AsyncStaticWebHandler: public AsyncWebHandler
 {
     using File = fs::File;
@@ -63,8 +128,21 @@ class AsyncStaticWebHandler: public AsyncWebHandler
 
   private:
     bool _getFile(AsyncWebServerRequest *request);
-    bool _fileExists(AsyncWebServerRequest *request, const String& path);
-    uint8_t _countBits(const uint8_t value) const;
+    bool _resolveFile(AsyncWebServerRequest *request);
+    bool _fileExists(AsyncWebServerRequest *request, const String& path, const String& variant = String());
+    String _openedVariant(AsyncWebServerRequest *request, const String& path);
+    void _checkFilesChanged();
+    AwsResolveEntry* _resolveFind(const String& url, uint8_t accept);
+    void _resolveStore(const String& url, uint8_t accept, const String& path, const String& variant);
+    String _getETag(const String& path, File& file);
+    bool _isNotModified(AsyncWebServerRequest *request, const String& etag);
+    void _sendNotModified(AsyncWebServerRequest *request, const String& etag, bool vary);
+    bool _useCache(AsyncWebServerRequest *request);
+    uint8_t _acceptedEncodings(AsyncWebServerRequest *request);
+    AsyncCachedFile* _cacheFind(const String& path, uint8_t accept);
+    AsyncCachedFile* _cacheAdd(AsyncWebServerRequest *request, const String& path, const String& variant,
+                               const String& etag);
+    void _cacheRemove(AsyncCachedFile* file);
 
   protected:
     FS _fs;
@@ -75,11 +153,24 @@ class AsyncStaticWebHandler: public AsyncWebHandler
     String _last_modified;
     AwsTemplateProcessor _callback;
     bool _isDir;
-    bool _gzipFirst;
-    uint8_t _gzipStats;
+    AwsETagEntry _etags[STATIC_ETAG_CACHE_SIZE];
+    uint8_t _etagNext;
+    LinkedList<AsyncCachedFile*> _cache;
+    size_t _cacheBudget;
+    size_t _cacheMaxFileSize;
+    size_t _cacheUsed;
+    uint32_t _cacheClock;
+    uint32_t _cacheHits;
+    uint32_t _cacheMisses;
+    AwsResolveEntry _resolved[STATIC_RESOLVE_CACHE_SIZE];
+    uint8_t _resolveNext;
+    uint32_t _filesGeneration;
+
+    static uint32_t _changesGeneration;
 
   public:
     AsyncStaticWebHandler(const char* uri, FS& fs, const char* path, const char* cache_control);
+    ~AsyncStaticWebHandler();
     virtual bool canHandle(AsyncWebServerRequest *request) override final;
     virtual void handleRequest(AsyncWebServerRequest *request) override final;
     AsyncStaticWebHandler& setIsDir(bool isDir);
@@ -88,9 +179,49 @@ class AsyncStaticWebHandler: public AsyncWebHandler
     AsyncStaticWebHandler& setLastModified(const char* last_modified);
     AsyncStaticWebHandler& setLastModified(struct tm* last_modified);
 
+    // Forget the cached ETag of a file (FS path), or of all files. Needed when a file is rewritten
+    // with the same size on a filesystem without modification time (SPIFFS)
+    void invalidateETags(const String& path = String());
+
+    // Keep files up to maxFileSize bytes in RAM, least recently used first out when budget bytes are used.
+    // 0 disables the cache
+    AsyncStaticWebHandler& setCache(size_t budget, size_t maxFileSize = STATIC_CACHE_MAX_FILE_SIZE);
+
+    // Drop a file (FS path, any variant), or all files, from the RAM cache
+    void invalidateCache(const String& path = String());
+
+    // To be called after files are written, created or deleted behind the web server (SPIFFSEditor does).
+    // Every AsyncStaticWebHandler then forgets its URL resolutions, ETags and RAM copies.
+    static void filesChanged();
+
+    /////////////////////////////////////////////////
+
+    inline uint32_t cacheHits() const
+    {
+      return _cacheHits;
+    }
+
+    /////////////////////////////////////////////////
+
+    inline uint32_t cacheMisses() const
+    {
+      return _cacheMisses;
+    }
+
+    /////////////////////////////////////////////////
+
+    // Bytes of file content held in RAM
+    inline size_t cacheSize() const
+    {
+      return _cacheUsed;
+    }
+
+    /////////////////////////////////////////////////
+
     AsyncStaticWebHandler& setTemplateProcessor(AwsTemplateProcessor newCallback)
     {
       _callback = newCallback;
+      invalidateCache();
       return *this;
     }
 };
@@ -108,10 +239,70 @@ class AsyncCallbackWebHandler: public AsyncWebHandler
     ArUploadHandlerFunction _onUpload;
     ArBodyHandlerFunction _onBody;
     bool _isRegex;
+    LinkedList<AsyncRenderedEntry*> _rendered;    // Oldest first
+    StringArray _cacheParams;
+    StringArray _cacheHeaders;
+    uint32_t _cacheTtl;
+    size_t _cacheBudget;
+    size_t _cacheMaxSize;
+    size_t _cacheUsed;
+    uint32_t _cacheHits;
+    uint32_t _cacheMisses;
+
+    String _cacheKey(AsyncWebServerRequest *request);
+    bool _cacheReplay(AsyncWebServerRequest *request);
+    void _cacheRemove(AsyncRenderedEntry* entry);
 
   public:
     AsyncCallbackWebHandler() : _uri(), _method(HTTP_ANY), _onRequest(NULL), _onUpload(NULL), _onBody(NULL),
-      _isRegex(false) {}
+      _isRegex(false),
+      _rendered(LinkedList<AsyncRenderedEntry*>([](AsyncRenderedEntry* const & entry) { entry->release(); })),
+      _cacheTtl(0), _cacheBudget(0), _cacheMaxSize(RESPONSE_CACHE_MAX_SIZE), _cacheUsed(0), _cacheHits(0),
+      _cacheMisses(0) {}
+
+    /////////////////////////////////////////////////
+
+    ~AsyncCallbackWebHandler()
+    {
+      _rendered.free();
+      _cacheParams.free();
+      _cacheHeaders.free();
+    }
+
+    /////////////////////////////////////////////////
+
+    // Replay the responses of GET requests for ttl ms without calling the handler. They are keyed by URL, plus
+    // the params and headers given to cacheKeyParam() / cacheKeyHeader(). Oldest out when budget bytes are used.
+    // Responses sent through a Stream or a callback filler are never cached. 0 disables the cache
+    AsyncCallbackWebHandler& setCache(uint32_t ttl, size_t budget = RESPONSE_CACHE_BUDGET,
+                                      size_t maxSize = RESPONSE_CACHE_MAX_SIZE);
+    AsyncCallbackWebHandler& cacheKeyParam(const String& name);
+    AsyncCallbackWebHandler& cacheKeyHeader(const String& name);
+
+    // Drop the cached responses of a URL, or all of them, e.g. when the data they show changed
+    void invalidateCache(const String& url = String());
+
+    /////////////////////////////////////////////////
+
+    inline uint32_t cacheHits() const
+    {
+      return _cacheHits;
+    }
+
+    /////////////////////////////////////////////////
+
+    inline uint32_t cacheMisses() const
+    {
+      return _cacheMisses;
+    }
+
+    /////////////////////////////////////////////////
+
+    // Bytes of rendered responses held in RAM
+    inline size_t cacheSize() const
+    {
+      return _cacheUsed;
+    }
 
     /////////////////////////////////////////////////
 
@@ -213,6 +404,9 @@ class AsyncCallbackWebHandler: public AsyncWebHandler
       if ((_username != "" && _password != "") && !request->authenticate(_username.c_str(), _password.c_str()))
         return request->requestAuthentication();
 
+      if (_cacheReplay(request))
+        return;
+
       if (_onRequest)
         _onRequest(request);
       else
@@ -221,6 +415,12 @@ class AsyncCallbackWebHandler: public AsyncWebHandler
 
     /////////////////////////////////////////////////
 
+    // Renders and keeps the responses of cached GET requests
+    virtual AsyncWebServerResponse* _beforeSend(AsyncWebServerRequest *request,
+                                                AsyncWebServerResponse *response) override;
+
+    /////////////////////////////////////////////////
+
     virtual void handleUpload(AsyncWebServerRequest *request, const String& filename, size_t index, uint8_t *data,
                               size_t len, bool final) override final
     {
@@ -46,9 +46,16 @@ namespace eth {
 
 /////////////////////////////////////////////////
 
+uint32_t AsyncStaticWebHandler::_changesGeneration = 0;
+
+/////////////////////////////////////////////////
+
 AsyncStaticWebHandler::AsyncStaticWebHandler(const char* uri, FS& fs, const char* path, const char* cache_control)
   : _fs(fs), _uri(uri), _path(path), _default_file("index.htm"), _cache_control(cache_control), _last_modified(""),
-    _callback(nullptr)
+    _callback(nullptr), _etagNext(0),
+    _cache(LinkedList<AsyncCachedFile*>([](AsyncCachedFile* const & file) { file->release(); })),
+    _cacheBudget(0), _cacheMaxFileSize(STATIC_CACHE_MAX_FILE_SIZE), _cacheUsed(0), _cacheClock(0), _cacheHits(0),
+    _cacheMisses(0), _resolveNext(0), _filesGeneration(_changesGeneration)
 {
   // Ensure leading '/'
   if (_uri.length() == 0 || _uri[0] != '/')
@@ -68,10 +75,6 @@ AsyncStaticWebHandler::AsyncStaticWebHandler(const char* uri, FS& fs, const char
 
   if (_path[_path.length() - 1] == '/')
     _path = _path.substring(0, _path.length() - 1);
-
-  // Reset stats
-  _gzipFirst = false;
-  _gzipStats = 0xF8;
 }
 
 /////////////////////////////////////////////////
@@ -97,6 +100,7 @@ AsyncStaticWebHandler& AsyncStaticWebHandler::setDefaultFile(const char* filenam
 AsyncStaticWebHandler& AsyncStaticWebHandler::setCacheControl(const char* cache_control)
 {
   _cache_control = String(cache_control);
+  invalidateCache();
 
   return *this;
 }
@@ -106,6 +110,7 @@ AsyncStaticWebHandler& AsyncStaticWebHandler::setCacheControl(const char* cache_
 AsyncStaticWebHandler& AsyncStaticWebHandler::setLastModified(const char* last_modified)
 {
   _last_modified = String(last_modified);
+  invalidateCache();
 
   return *this;
 }
@@ -136,8 +141,15 @@ bool AsyncStaticWebHandler::canHandle(AsyncWebServerRequest *request)
     if (_last_modified.length())
       request->addInterestingHeader("If-Modified-Since");
 
-    if (_cache_control.length())
-      request->addInterestingHeader("If-None-Match");
+    // ETags are always sent, so conditional requests work with or without Cache-Control
+    request->addInterestingHeader("If-None-Match");
+
+    // To choose between precompressed variants
+    request->addInterestingHeader("Accept-Encoding");
+
+    // Byte ranges, for resumable downloads and media seeking
+    request->addInterestingHeader("Range");
+    request->addInterestingHeader("If-Range");
 
     AWS_LOGDEBUG("[AsyncStaticWebHandler::canHandle] TRUE");
 
@@ -150,6 +162,49 @@ bool AsyncStaticWebHandler::canHandle(AsyncWebServerRequest *request)
 /////////////////////////////////////////////////
 
 bool AsyncStaticWebHandler::_getFile(AsyncWebServerRequest *request)
+{
+  _checkFilesChanged();
+
+  const String& url = request->url();
+  const uint8_t accept = _acceptedEncodings(request);
+  AwsResolveEntry* entry = _resolveFind(url, accept);
+
+  if (entry)
+  {
+    // Known missing, e.g. a burst of 404 from a scanner
+    if (!entry->path.length())
+      return false;
+
+    // Known file : one open, of the right variant
+    if (_fileExists(request, entry->path, entry->variant))
+      return true;
+
+    // Removed since : resolve again
+    entry->url = String();
+  }
+
+  bool found = _resolveFile(request);
+
+  // A RAM copy was used, nothing was opened
+  if (found && !request->_tempFile)
+    return true;
+
+  if (found)
+  {
+    String path = String((char*)request->_tempObject);
+    _resolveStore(url, accept, path, _openedVariant(request, path));
+  }
+  else
+  {
+    _resolveStore(url, accept, String(), String());
+  }
+
+  return found;
+}
+
+/////////////////////////////////////////////////
+
+bool AsyncStaticWebHandler::_resolveFile(AsyncWebServerRequest *request)
 {
   // Remove the found uri
   String path = request->url().substring(_uri.length());
@@ -178,75 +233,201 @@ bool AsyncStaticWebHandler::_getFile(AsyncWebServerRequest *request)
 
 /////////////////////////////////////////////////
 
-#define FILE_IS_REAL(f) (f == true && !f.isDirectory())
+bool AsyncStaticWebHandler::_fileExists(AsyncWebServerRequest *request, const String& path, const String& variant)
+{
+  AsyncCachedFile* cached = _useCache(request) ? _cacheFind(path, _acceptedEncodings(request)) : nullptr;
+
+  // Recently checked RAM copy : no FS access at all
+  if (cached && (millis() - cached->checkedAt) < STATIC_CACHE_CHECK_INTERVAL)
+  {
+    request->_tempFile = File();
+  }
+  else
+  {
+    if (variant.length())
+    {
+      // Already negotiated
+      request->_tempFile = _fs.open(variant, "r");
+
+      if (request->_tempFile && request->_tempFile.isDirectory())
+        request->_tempFile.close();
+    }
+    else
+    {
+      // Best variant the client accepts : path.br, path.gz or path
+      request->_tempFile = AsyncFileResponse::openVariant(_fs, path, request);
+    }
+
+    if (!request->_tempFile)
+    {
+      if (cached)
+        _cacheRemove(cached);
+
+      return false;
+    }
+  }
+
+  // Extract the file name from the path and keep it in _tempObject
+  size_t pathLen = path.length();
+  char * _tempPath = (char*)malloc(pathLen + 1);
+  snprintf(_tempPath, pathLen + 1, "%s", path.c_str());
+  request->_tempObject = (void*)_tempPath;
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+
+// FS path of the variant opened in request->_tempFile : path, path.gz or path.br
+String AsyncStaticWebHandler::_openedVariant(AsyncWebServerRequest *request, const String& path)
+{
+  String name = String(request->_tempFile.name());
+
+  if (name.endsWith(".gz") && !path.endsWith(".gz"))
+    return path + ".gz";
+
+  if (name.endsWith(".br") && !path.endsWith(".br"))
+    return path + ".br";
+
+  return path;
+}
+
+/////////////////////////////////////////////////
+
+void AsyncStaticWebHandler::filesChanged()
+{
+  _changesGeneration++;
+}
 
 /////////////////////////////////////////////////
 
-bool AsyncStaticWebHandler::_fileExists(AsyncWebServerRequest *request, const String& path)
+void AsyncStaticWebHandler::_checkFilesChanged()
 {
-  bool fileFound = false;
-  bool gzipFound = false;
+  if (_filesGeneration == _changesGeneration)
+    return;
 
-  String gzip = path + ".gz";
+  _filesGeneration = _changesGeneration;
 
-  if (_gzipFirst)
-  {
-    request->_tempFile = _fs.open(gzip, "r");
-    gzipFound = FILE_IS_REAL(request->_tempFile);
+  for (auto& entry : _resolved)
+    entry.url = String();
 
-    if (!gzipFound)
+  invalidateETags();
+  invalidateCache();
+}
+
+/////////////////////////////////////////////////
+
+AwsResolveEntry* AsyncStaticWebHandler::_resolveFind(const String& url, uint8_t accept)
+{
+  for (auto& entry : _resolved)
+  {
+    if (entry.accept == accept && entry.url.length() && entry.url == url)
     {
-      request->_tempFile = _fs.open(path, "r");
-      fileFound = FILE_IS_REAL(request->_tempFile);
+      // Missing files may appear without notice : don't trust it for too long
+      if (!entry.path.length() && (millis() - entry.storedAt) >= STATIC_RESOLVE_NEGATIVE_TTL)
+      {
+        entry.url = String();
+
+        return nullptr;
+      }
+
+      return &entry;
     }
   }
-  else
+
+  return nullptr;
+}
+
+/////////////////////////////////////////////////
+
+void AsyncStaticWebHandler::_resolveStore(const String& url, uint8_t accept, const String& path, const String& variant)
+{
+  AwsResolveEntry& entry = _resolved[_resolveNext];
+  _resolveNext = (_resolveNext + 1) % STATIC_RESOLVE_CACHE_SIZE;
+
+  entry.url = url;
+  entry.accept = accept;
+  entry.path = path;
+  entry.variant = variant;
+  entry.storedAt = millis();
+}
+
+/////////////////////////////////////////////////
+
+String AsyncStaticWebHandler::_getETag(const String& path, File& file)
+{
+  const size_t size = file.size();
+  const time_t lastWrite = file.getLastWrite();
+
+  for (const auto& entry : _etags)
+  {
+    if (entry.size == size && entry.lastWrite == lastWrite && entry.path == path && entry.etag.length())
+      return entry.etag;
+  }
+
+  // Not known yet : hash the content once (FNV-1a), then rewind the file for the response
+  uint32_t hash = 2166136261UL;
+  bool weak = false;
+
+  if (size <= STATIC_ETAG_HASH_MAX_SIZE)
   {
-    request->_tempFile = _fs.open(path, "r");
-    fileFound = FILE_IS_REAL(request->_tempFile);
+    uint8_t buf[128];
+    size_t readLen;
 
-    if (!fileFound)
+    while ((readLen = file.read(buf, sizeof(buf))) > 0)
     {
-      request->_tempFile = _fs.open(gzip, "r");
-      gzipFound = FILE_IS_REAL(request->_tempFile);
+      for (size_t i = 0; i < readLen; i++)
+        hash = (hash ^ buf[i]) * 16777619UL;
     }
-  }
-
-  bool found = fileFound || gzipFound;
 
-  if (found)
+    file.seek(0, fs::SeekSet);
+  }
+  else
   {
-    // Extract the file name from the path and keep it in _tempObject
-    size_t pathLen = path.length();
-    char * _tempPath = (char*)malloc(pathLen + 1);
-    snprintf(_tempPath, pathLen + 1, "%s", path.c_str());
-    request->_tempObject = (void*)_tempPath;
-
-    // Calculate gzip statistic
-    _gzipStats = (_gzipStats << 1) + (gzipFound ? 1 : 0);
-
-    if (_gzipStats == 0x00)
-      _gzipFirst = false; // All files are not gzip
-    else if (_gzipStats == 0xFF)
-      _gzipFirst = true; // All files are gzip
-    else
-      _gzipFirst = _countBits(_gzipStats) > 4; // IF we have more gzip files - try gzip first
+    // Not derived from the content : the same path rewritten with the same size may keep it
+    for (size_t i = 0; i < path.length(); i++)
+      hash = (hash ^ (uint8_t) path[i]) * 16777619UL;
+
+    weak = true;
   }
 
-  return found;
+  char etag[40];
+  snprintf(etag, sizeof(etag), "%s\"%08x-%x-%lx\"", weak ? "W/" : "", (unsigned) hash, (unsigned) size,
+           (unsigned long) lastWrite);
+
+  AwsETagEntry& entry = _etags[_etagNext];
+  _etagNext = (_etagNext + 1) % STATIC_ETAG_CACHE_SIZE;
+
+  entry.path = path;
+  entry.size = size;
+  entry.lastWrite = lastWrite;
+  entry.etag = etag;
+
+  AWS_LOGDEBUG3("[AsyncStaticWebHandler::_getETag] path =", path, ", ETag =", etag);
+
+  return entry.etag;
 }
 
 /////////////////////////////////////////////////
 
-uint8_t AsyncStaticWebHandler::_countBits(const uint8_t value) const
+void AsyncStaticWebHandler::invalidateETags(const String& path)
 {
-  uint8_t w = value;
-  uint8_t n;
+  for (auto& entry : _etags)
+  {
+    if (!path.length() || entry.path == path || entry.path == path + ".gz" || entry.path == path + ".br")
+    {
+      entry.path = String();
+      entry.etag = String();
+    }
+  }
+}
 
-  for (n = 0; w != 0; n++)
-    w &= w - 1;
+/////////////////////////////////////////////////
 
-  return n;
+// If-None-Match holds "*" or a list of (possibly weak) ETags, compared weakly : W/ is ignored on both sides
+static bool etagMatches(const String& ifNoneMatch, const String& etag)
+{
+  return ifNoneMatch == "*" || ifNoneMatch.indexOf(etag.startsWith("W/") ? etag.substring(2) : etag) >= 0;
 }
 
 /////////////////////////////////////////////////
@@ -261,45 +442,467 @@ void AsyncStaticWebHandler::handleRequest(AsyncWebServerRequest *request)
   if ((_username != "" && _password != "") && !request->authenticate(_username.c_str(), _password.c_str()))
     return request->requestAuthentication();
 
+  const bool useCache = _useCache(request);
+  AsyncCachedFile* cached = useCache ? _cacheFind(filename, _acceptedEncodings(request)) : nullptr;
+  bool hit = true;
+
   if (request->_tempFile == true)
   {
-    String etag = String(request->_tempFile.size());
+    // Each variant (path, path.gz, path.br) has its own ETag
+    String variant = _openedVariant(request, filename);
 
-    if (_last_modified.length() && _last_modified == request->header("If-Modified-Since"))
+    // The file was opened again : drop the RAM copy if it changed
+    if (cached && (cached->variant != variant || cached->size != request->_tempFile.size()
+                   || cached->lastWrite != request->_tempFile.getLastWrite()))
     {
-      request->_tempFile.close();
-      request->send(304); // Not modified
+      _cacheRemove(cached);
+      cached = nullptr;
     }
-    else if (_cache_control.length() && request->hasHeader("If-None-Match")
-             && request->header("If-None-Match").equals(etag))
+
+    String etag = cached ? cached->etag : _getETag(variant, request->_tempFile);
+
+    if (!cached && useCache)
     {
-      request->_tempFile.close();
-      AsyncWebServerResponse * response = new AsyncBasicResponse(304); // Not modified
+      _cacheMisses++;
+      hit = false;
+      cached = _cacheAdd(request, filename, variant, etag);
+    }
 
-      response->addHeader("Cache-Control", _cache_control);
-      response->addHeader("ETag", etag);
-      request->send(response);
+    if (cached)
+    {
+      cached->checkedAt = millis();
+      request->_tempFile.close();
     }
     else
     {
-      AsyncWebServerResponse * response = new AsyncFileResponse(request->_tempFile, filename, String(), false, _callback);
+      if (_isNotModified(request, etag))
+      {
+        request->_tempFile.close();
+        _sendNotModified(request, etag, variant != filename);
+      }
+      else
+      {
+        AsyncWebServerResponse * response = new AsyncFileResponse(request->_tempFile, filename, String(), false, _callback);
 
-      if (_last_modified.length())
-        response->addHeader("Last-Modified", _last_modified);
+        if (_last_modified.length())
+          response->addHeader("Last-Modified", _last_modified);
+
+        if (_cache_control.length())
+          response->addHeader("Cache-Control", _cache_control);
 
-      if (_cache_control.length())
-      {
-        response->addHeader("Cache-Control", _cache_control);
         response->addHeader("ETag", etag);
+
+        request->send(response);
       }
 
-      request->send(response);
+      return;
     }
   }
+
+  if (cached)
+  {
+    if (hit)
+      _cacheHits++;
+
+    cached->usedAt = ++_cacheClock;
+
+    if (_isNotModified(request, cached->etag))
+      _sendNotModified(request, cached->etag, cached->variant != cached->path);
+    else
+      request->send(new AsyncCachedFileResponse(cached));
+  }
   else
   {
     request->send(404);
   }
 }
 
+/////////////////////////////////////////////////
+
+bool AsyncStaticWebHandler::_isNotModified(AsyncWebServerRequest *request, const String& etag)
+{
+  // If-None-Match takes precedence over If-Modified-Since (RFC 7232)
+  if (request->hasHeader("If-None-Match"))
+    return etagMatches(request->header("If-None-Match"), etag);
+
+  return _last_modified.length() && _last_modified == request->header("If-Modified-Since");
+}
+
+/////////////////////////////////////////////////
+
+void AsyncStaticWebHandler::_sendNotModified(AsyncWebServerRequest *request, const String& etag, bool vary)
+{
+  AsyncWebServerResponse * response = new AsyncBasicResponse(304); // Not modified
+
+  if (_cache_control.length())
+    response->addHeader("Cache-Control", _cache_control);
+
+  if (vary)
+    response->addHeader("Vary", "Accept-Encoding");
+
+  response->addHeader("ETag", etag);
+  request->send(response);
+}
+
+/////////////////////////////////////////////////
+
+AsyncStaticWebHandler::~AsyncStaticWebHandler()
+{
+  _cache.free();
+}
+
+/////////////////////////////////////////////////
+
+AsyncStaticWebHandler& AsyncStaticWebHandler::setCache(size_t budget, size_t maxFileSize)
+{
+  _cacheBudget = budget;
+  _cacheMaxFileSize = maxFileSize;
+
+  invalidateCache();
+
+  return *this;
+}
+
+/////////////////////////////////////////////////
+
+void AsyncStaticWebHandler::invalidateCache(const String& path)
+{
+  if (!path.length())
+  {
+    _cache.free();
+    _cacheUsed = 0;
+
+    return;
+  }
+
+  AsyncCachedFile* file;
+
+  while ((file = _cacheFind(path, 0xFF)) != nullptr)
+    _cacheRemove(file);
+}
+
+/////////////////////////////////////////////////
+
+// Ranges and template processing are always served from the FS
+bool AsyncStaticWebHandler::_useCache(AsyncWebServerRequest *request)
+{
+  return _cacheBudget && !_callback && !request->hasHeader("Range");
+}
+
+/////////////////////////////////////////////////
+
+uint8_t AsyncStaticWebHandler::_acceptedEncodings(AsyncWebServerRequest *request)
+{
+  return (request->acceptsEncoding("gzip") ? AWS_ACCEPT_GZIP : 0) | (request->acceptsEncoding("br") ? AWS_ACCEPT_BR : 0);
+}
+
+/////////////////////////////////////////////////
+
+// accept 0xFF matches any entry for path, requested or actually read (path.gz, path.br)
+AsyncCachedFile* AsyncStaticWebHandler::_cacheFind(const String& path, uint8_t accept)
+{
+  for (const auto& file : _cache)
+  {
+    if (accept == 0xFF ? (file->path == path || file->variant == path) : (file->accept == accept && file->path == path))
+      return file;
+  }
+
+  return nullptr;
+}
+
+/////////////////////////////////////////////////
+
+void AsyncStaticWebHandler::_cacheRemove(AsyncCachedFile* file)
+{
+  _cacheUsed -= file->size;
+
+  // The list releases its reference, responses still sending the file keep theirs
+  _cache.remove(file);
+}
+
+/////////////////////////////////////////////////
+
+// Read the open file into RAM with its headers. Returns nullptr if the file is not cacheable.
+AsyncCachedFile* AsyncStaticWebHandler::_cacheAdd(AsyncWebServerRequest *request, const String& path,
+                                                  const String& variant, const String& etag)
+{
+  File& content = request->_tempFile;
+  const size_t size = content.size();
+
+  if (size > _cacheMaxFileSize || size > _cacheBudget)
+    return nullptr;
+
+  uint8_t* data = (uint8_t*) malloc(size ? size : 1);
+
+  if (!data)
+    return nullptr;
+
+  if (content.read(data, size) != size)
+  {
+    free(data);
+    content.seek(0, fs::SeekSet);
+
+    return nullptr;
+  }
+
+  // Least recently used out first
+  while (_cacheUsed + size > _cacheBudget && !_cache.isEmpty())
+  {
+    AsyncCachedFile* oldest = _cache.front();
+
+    for (const auto& file : _cache)
+    {
+      if (file->usedAt < oldest->usedAt)
+        oldest = file;
+    }
+
+    _cacheRemove(oldest);
+  }
+
+  AsyncCachedFile* file = new AsyncCachedFile();
+
+  file->path = path;
+  file->accept = _acceptedEncodings(request);
+  file->variant = variant;
+  file->size = size;
+  file->lastWrite = content.getLastWrite();
+  file->etag = etag;
+  file->data = data;
+
+  // Everything but the status line and the length is known now
+  String& headers = file->headers;
+  int filenameStart = path.lastIndexOf('/') + 1;
+
+  headers = "Content-Type: ";
+  headers += AsyncFileResponse::contentTypeFor(path);
+  headers += "\r\n";
+
+  if (variant != path)
+  {
+    headers += "Content-Encoding: ";
+    headers += variant.endsWith(".br") ? "br" : "gzip";
+    headers += "\r\nVary: Accept-Encoding\r\n";
+  }
+
+  headers += "Content-Disposition: inline; filename=\"";
+  headers += path.substring(filenameStart);
+  headers += "\"\r\n";
+
+  if (_last_modified.length())
+    headers += "Last-Modified: " + _last_modified + "\r\n";
+
+  if (_cache_control.length())
+    headers += "Cache-Control: " + _cache_control + "\r\n";
+
+  headers += "ETag: " + etag + "\r\n";
+
+  _cache.add(file);
+  _cacheUsed += size;
+
+  AWS_LOGDEBUG3("[AsyncStaticWebHandler::_cacheAdd] variant =", variant, ", size =", size);
+
+  return file;
+}
+
+/////////////////////////////////////////////////
+/////////////////////////////////////////////////
+
+/*
+   Callback Handler : rendered response cache
+ * */
+
+AsyncCallbackWebHandler& AsyncCallbackWebHandler::setCache(uint32_t ttl, size_t budget, size_t maxSize)
+{
+  _cacheTtl = ttl;
+  _cacheBudget = budget;
+  _cacheMaxSize = maxSize;
+
+  invalidateCache();
+
+  return *this;
+}
+
+/////////////////////////////////////////////////
+
+AsyncCallbackWebHandler& AsyncCallbackWebHandler::cacheKeyParam(const String& name)
+{
+  _cacheParams.add(name);
+  invalidateCache();
+
+  return *this;
+}
+
+/////////////////////////////////////////////////
+
+AsyncCallbackWebHandler& AsyncCallbackWebHandler::cacheKeyHeader(const String& name)
+{
+  _cacheHeaders.add(name);
+  invalidateCache();
+
+  return *this;
+}
+
+/////////////////////////////////////////////////
+
+void AsyncCallbackWebHandler::invalidateCache(const String& url)
+{
+  if (!url.length())
+  {
+    _rendered.free();
+    _cacheUsed = 0;
+
+    return;
+  }
+
+  // Keys are the HTTP version digit, then the URL, then '\n' and the varying values
+  bool removed;
+
+  do
+  {
+    removed = false;
+
+    for (const auto& entry : _rendered)
+    {
+      const int end = entry->key.indexOf('\n');
+
+      if (entry->key.substring(1, end < 0 ? entry->key.length() : end) == url)
+      {
+        _cacheRemove(entry);
+        removed = true;
+
+        break;
+      }
+    }
+  } while (removed);
+}
+
+/////////////////////////////////////////////////
+
+String AsyncCallbackWebHandler::_cacheKey(AsyncWebServerRequest *request)
+{
+  String key = String(request->version()) + request->url();
+
+  for (const auto& name : _cacheParams)
+  {
+    AsyncWebParameter* p = request->getParam(name);
+
+    key += "\n" + name + "=";
+
+    if (p)
+      key += p->value();
+  }
+
+  for (const auto& name : _cacheHeaders)
+  {
+    AsyncWebHeader* h = request->getHeader(name);
+
+    key += "\n" + name + ":";
+
+    if (h)
+      key += h->value();
+  }
+
+  return key;
+}
+
+/////////////////////////////////////////////////
+
+void AsyncCallbackWebHandler::_cacheRemove(AsyncRenderedEntry* entry)
+{
+  _cacheUsed -= entry->data.length();
+
+  // onRemove releases the entry
+  _rendered.remove(entry);
+}
+
+/////////////////////////////////////////////////
+
+bool AsyncCallbackWebHandler::_cacheReplay(AsyncWebServerRequest *request)
+{
+  if (!_cacheTtl || request->method() != HTTP_GET)
+    return false;
+
+  const String key = _cacheKey(request);
+  const uint32_t now = millis();
+
+  for (const auto& entry : _rendered)
+  {
+    if (entry->key != key)
+      continue;
+
+    if (now - entry->storedAt >= _cacheTtl)
+    {
+      _cacheRemove(entry);
+
+      break;
+    }
+
+    _cacheHits++;
+    request->send(new AsyncRenderedResponse(entry));
+
+    return true;
+  }
+
+  _cacheMisses++;
+
+  return false;
+}
+
+/////////////////////////////////////////////////
+
+AsyncWebServerResponse* AsyncCallbackWebHandler::_beforeSend(AsyncWebServerRequest *request,
+                                                             AsyncWebServerResponse *response)
+{
+  if (!_cacheTtl || request->method() != HTTP_GET || response->code() != 200)
+    return response;
+
+  String rendered;
+  const size_t maxLength = (_cacheMaxSize < _cacheBudget) ? _cacheMaxSize : _cacheBudget;
+
+  // Cache hits (AsyncRenderedResponse), responses without a fixed body and those too long to be cached
+  // are not rendered : never more than maxLength + 1 bytes in RAM
+  if (!response->_render(request->version(), rendered, maxLength))
+    return response;
+
+  delete response;
+
+  AsyncRenderedEntry* entry = new AsyncRenderedEntry();
+  const size_t size = rendered.length();
+
+  entry->data = std::move(rendered);
+
+  if (size <= _cacheMaxSize && size <= _cacheBudget)
+  {
+    entry->key = _cacheKey(request);
+    entry->storedAt = millis();
+
+    // Same key rendered twice (deferred responses), or oldest out
+    for (const auto& old : _rendered)
+    {
+      if (old->key == entry->key)
+      {
+        _cacheRemove(old);
+
+        break;
+      }
+    }
+
+    while (_cacheUsed + size > _cacheBudget && _rendered.length())
+      _cacheRemove(_rendered.front());
+
+    entry->retain();
+    _rendered.add(entry);
+    _cacheUsed += size;
+
+    AWS_LOGDEBUG3("[AsyncCallbackWebHandler::_beforeSend] cached", entry->key, ", size =", size);
+  }
+
+  response = new AsyncRenderedResponse(entry);
+  entry->release();
+
+  return response;
+}
+
+/////////////////////////////////////////////////
+
 }
\ No newline at end of file
@@ -65,6 +65,7 @@ AsyncWebServerRequest::AsyncWebServerRequest(AsyncWebServer* s, AsyncClient* c)
   , _server(s)
   , _handler(NULL)
   , _response(NULL)
+  , _deferred(NULL)
   , _temp()
   , _parseState(0)
   , _version(0)
@@ -165,6 +166,11 @@ AsyncWebServerRequest::~AsyncWebServerRequest()
     delete _response;
   }
 
+  if (_deferred != NULL)
+  {
+    _deferred->_cancel();
+  }
+
   if (_tempObject != NULL)
   {
     free(_tempObject);
@@ -321,6 +327,11 @@ void AsyncWebServerRequest::_removeNotInterestingHeaders()
 
 void AsyncWebServerRequest::_onPoll()
 {
+  if (_deferred != NULL)
+  {
+    _pollDeferred();
+  }
+
   if (_response != NULL && _client != NULL && _client->canSend() && !_response->_finished())
   {
     _response->_ack(this, 0, 0);
@@ -329,6 +340,22 @@ void AsyncWebServerRequest::_onPoll()
 
 /////////////////////////////////////////////////
 
+// On the AsyncTCP task : sends the response of a worker, if any yet
+void AsyncWebServerRequest::_pollDeferred()
+{
+  AsyncWebServerResponse* response = _deferred->_take();
+
+  if (response == NULL)
+    return;
+
+  _deferred->_release();
+  _deferred = NULL;
+
+  send(response);
+}
+
+/////////////////////////////////////////////////
+
 void AsyncWebServerRequest::_onAck(size_t len, uint32_t time)
 {
   AWS_LOGDEBUG3("onAck: len =", len, ", time =", time);
@@ -353,6 +380,10 @@ void AsyncWebServerRequest::_onAck(size_t len, uint32_t time)
 void AsyncWebServerRequest::_onError(int8_t error)
 {
   WT32_ETH01_AWS_UNUSED(error);
+
+  // Reset or aborted : the pcb is already freed, nothing can be retransmitted anymore
+  if (_response)
+    _response->_connectionAborted();
 }
 
 /////////////////////////////////////////////////
@@ -363,7 +394,14 @@ void AsyncWebServerRequest::_onTimeout(uint32_t time)
 
   AWS_LOGDEBUG3("TIMEOUT: time =", time, ", state =", _client->stateToString());
 
-  _client->close();
+  // A graceful close keeps the pcb, and its unacked data, alive after the response is deleted
+  if (_response && _response->_unackedByReference())
+  {
+    _client->abort();
+    _response->_connectionAborted();
+  }
+  else
+    _client->close();
 }
 
 /////////////////////////////////////////////////
@@ -1198,6 +1236,20 @@ void AsyncWebServerRequest::addInterestingHeader(const String& name)
 
 void AsyncWebServerRequest::send(AsyncWebServerResponse *response)
 {
+  // Deferred : the worker's response is the one sent, see _pollDeferred()
+  if (_deferred != NULL)
+  {
+    AWS_LOGERROR("AsyncWebServerRequest::send: request deferred, response dropped");
+
+    if (response != NULL)
+      delete response;
+
+    return;
+  }
+
+  if (_handler != NULL && response != NULL)
+    response = _handler->_beforeSend(this, response);
+
   _response = response;
 
   if (_response == NULL)
@@ -1222,6 +1274,132 @@ void AsyncWebServerRequest::send(AsyncWebServerResponse *response)
   }
 }
 
+/////////////////////////////////////////////////
+
+AsyncDeferredResponse * AsyncWebServerRequest::defer()
+{
+  if (_response != NULL || _deferred != NULL)
+    return NULL;
+
+  _client->setRxTimeout(0);
+  _deferred = new AsyncDeferredResponse();
+
+  return _deferred;
+}
+
+/////////////////////////////////////////////////
+/////////////////////////////////////////////////
+
+/*
+   Deferred Response : shared by the request (AsyncTCP task) and a worker task, freed by the last one
+ * */
+
+AsyncDeferredResponse::AsyncDeferredResponse()
+  : _lock(portMUX_INITIALIZER_UNLOCKED)
+  , _refs(2)
+  , _cancelled(false)
+  , _sent(false)
+  , _response(NULL)
+{
+}
+
+/////////////////////////////////////////////////
+
+AsyncDeferredResponse::~AsyncDeferredResponse()
+{
+  // Given by the worker, never picked up
+  if (_response != NULL)
+  {
+    delete _response;
+  }
+}
+
+/////////////////////////////////////////////////
+
+AsyncWebServerResponse * AsyncDeferredResponse::_take()
+{
+  portENTER_CRITICAL(&_lock);
+
+  AsyncWebServerResponse* response = _response;
+  _response = NULL;
+
+  portEXIT_CRITICAL(&_lock);
+
+  return response;
+}
+
+/////////////////////////////////////////////////
+
+void AsyncDeferredResponse::_cancel()
+{
+  portENTER_CRITICAL(&_lock);
+  _cancelled = true;
+  portEXIT_CRITICAL(&_lock);
+
+  _release();
+}
+
+/////////////////////////////////////////////////
+
+void AsyncDeferredResponse::_release()
+{
+  portENTER_CRITICAL(&_lock);
+  bool last = (--_refs == 0);
+  portEXIT_CRITICAL(&_lock);
+
+  if (last)
+    delete this;
+}
+
+/////////////////////////////////////////////////
+
+bool AsyncDeferredResponse::cancelled() const
+{
+  portENTER_CRITICAL(&_lock);
+  bool cancelled = _cancelled;
+  portEXIT_CRITICAL(&_lock);
+
+  return cancelled;
+}
+
+/////////////////////////////////////////////////
+
+bool AsyncDeferredResponse::send(AsyncWebServerResponse *response)
+{
+  // The request must be answered anyway
+  if (response == NULL)
+    response = new AsyncBasicResponse(500);
+
+  portENTER_CRITICAL(&_lock);
+
+  // Once only : the worker's reference is released by the first call
+  bool first = !_sent;
+  bool accepted = first && !_cancelled;
+
+  _sent = true;
+
+  if (accepted)
+    _response = response;
+
+  portEXIT_CRITICAL(&_lock);
+
+  if (!accepted)
+    delete response;
+
+  // The handle may be freed from here on
+  if (first)
+    _release();
+
+  return accepted;
+}
+
+/////////////////////////////////////////////////
+
+bool AsyncDeferredResponse::send(int code, const String& contentType, const String& content)
+{
+  return send(new AsyncBasicResponse(code, contentType, content));
+}
+
 //RSMOD///////////////////////////////////////////////
 
 AsyncWebServerResponse * AsyncWebServerRequest::beginResponse(int code, const String& contentType, const char * content)
@@ -1251,8 +1429,18 @@ AsyncWebServerResponse * AsyncWebServerRequest::beginResponse(FS &fs, const Stri
                                                               bool download,
                                                               AwsTemplateProcessor callback)
 {
-  if (fs.exists(path) || (!download && fs.exists(path + ".gz")))
-    return new AsyncFileResponse(fs, path, contentType, download, callback);
+  if (download)
+  {
+    if (fs.exists(path))
+      return new AsyncFileResponse(fs, path, contentType, download, callback);
+
+    return NULL;
+  }
+
+  File content = AsyncFileResponse::openVariant(fs, path, this);
+
+  if (content == true)
+    return new AsyncFileResponse(content, path, contentType, download, callback);
 
   return NULL;
 }
@@ -1305,6 +1493,26 @@ AsyncResponseStream * AsyncWebServerRequest::beginResponseStream(const String& c
   return new AsyncResponseStream(contentType, bufferSize);
 }
 
+/////////////////////////////////////////////////
+
+AsyncScatterGatherResponse * AsyncWebServerRequest::beginScatterGatherResponse(int code, const String& contentType)
+{
+  return new AsyncScatterGatherResponse(code, contentType);
+}
+
+/////////////////////////////////////////////////
+
+AsyncScatterGatherResponse * AsyncWebServerRequest::beginSpanResponse(const String& contentType, size_t len,
+                                                                      AwsResponseSpanFiller filler,
+                                                                      AwsResponseSpanRelease release)
+{
+  AsyncScatterGatherResponse * response = new AsyncScatterGatherResponse(200, contentType);
+
+  response->addSpans(len, filler, release);
+
+  return response;
+}
+
 AsyncWebServerResponse * AsyncWebServerRequest::beginResponse_P(int code, const String& contentType,
                                                                 const uint8_t * content, size_t len,
                                                                 AwsTemplateProcessor callback)
@@ -1346,9 +1554,11 @@ void AsyncWebServerRequest::send(int code, const String& contentType, const Stri
 void AsyncWebServerRequest::send(FS &fs, const String& path, const String& contentType, bool download,
                                  AwsTemplateProcessor callback)
 {
-  if (fs.exists(path) || (!download && fs.exists(path + ".gz")))
+  AsyncWebServerResponse * response = beginResponse(fs, path, contentType, download, callback);
+
+  if (response)
   {
-    send(beginResponse(fs, path, contentType, download, callback));
+    send(response);
   }
   else
     send(404);
@@ -1656,6 +1866,50 @@ const String& AsyncWebServerRequest::headerName(size_t i) const
 
 /////////////////////////////////////////////////
 
+bool AsyncWebServerRequest::acceptsEncoding(const String& encoding) const
+{
+  const String& accepted = header("Accept-Encoding");
+  bool wildcard = false;
+  int start = 0;
+
+  while (start < (int) accepted.length())
+  {
+    int end = accepted.indexOf(',', start);
+
+    if (end < 0)
+      end = accepted.length();
+
+    String coding = accepted.substring(start, end);
+    start = end + 1;
+
+    // "gzip;q=0" explicitly refuses gzip
+    float quality = 1;
+    int semicolon = coding.indexOf(';');
+
+    if (semicolon >= 0)
+    {
+      int q = coding.indexOf("q=", semicolon);
+
+      if (q >= 0)
+        quality = coding.substring(q + 2).toFloat();
+
+      coding = coding.substring(0, semicolon);
+    }
+
+    coding.trim();
+
+    if (coding.equalsIgnoreCase(encoding))
+      return quality > 0;
+
+    if (coding == "*")
+      wildcard = quality > 0;
+  }
+
+  return wildcard;
+}
+
+/////////////////////////////////////////////////
+
 String AsyncWebServerRequest::urlDecode(const String& text) const
 {
   char temp[] = "0x00";
@@ -42,16 +42,17 @@
 #define ASYNCWEBSERVERRESPONSEIMPL_H_
 
 #ifdef Arduino_h
-  // arduino is not compatible with std::vector
+  // arduino is not compatible with std::min, std::max
   #undef min
   #undef max
 #endif
 
+#include <algorithm>
 #include <vector>
 
-/////////////////////////////////////////////////
+#include "AsyncJsonWriter.h"
 
-class cbuf;
+/////////////////////////////////////////////////
 
 namespace eth {
 
@@ -74,6 +75,7 @@ class AsyncBasicResponse: public AsyncWebServerResponse
 
     void _respond(AsyncWebServerRequest *request);
     size_t _ack(AsyncWebServerRequest *request, size_t len, uint32_t time);
+    virtual bool _render(uint8_t version, String& out, size_t maxLength) override;
 
     /////////////////////////////////////////////////
 
@@ -87,25 +89,86 @@ class AsyncBasicResponse: public AsyncWebServerResponse
 
 /////////////////////////////////////////////////
 
+// Lookahead cache for template processing. Data is pushed back in front of what is
+// already cached, and read from the front, so both ends must be O(1) : a growable ring of bytes.
+class ByteRingBuffer
+{
+  private:
+    uint8_t* _buf;
+    size_t _capacity;
+    size_t _head;
+    size_t _size;
+
+    bool _reserve(size_t capacity);
+    void _copyOut(uint8_t* data, size_t len) const;
+
+  public:
+    ByteRingBuffer(): _buf(nullptr), _capacity(0), _head(0), _size(0) {}
+    ~ByteRingBuffer();
+
+    ByteRingBuffer(const ByteRingBuffer &) = delete;
+    ByteRingBuffer &operator=(const ByteRingBuffer &) = delete;
+
+    /////////////////////////////////////////////////
+
+    inline size_t size() const
+    {
+      return _size;
+    }
+
+    /////////////////////////////////////////////////
+
+    inline bool empty() const
+    {
+      return _size == 0;
+    }
+
+    /////////////////////////////////////////////////
+
+    // Insert len bytes before the current content, keeping their order. Returns bytes stored.
+    size_t pushFront(const uint8_t* data, size_t len);
+
+    // Move up to len bytes from the front into data. Returns bytes read.
+    size_t popFront(uint8_t* data, size_t len);
+};
+
+/////////////////////////////////////////////////
+
 class AsyncAbstractResponse: public AsyncWebServerResponse
 {
   private:
     String _head;
-    // Data is inserted into cache at begin().
-    // This is inefficient with vector, but if we use some other container,
-    // we won't be able to access it as contiguous array of bytes when reading from it,
-    // so by gaining performance in one place, we'll lose it in another.
-    std::vector<uint8_t> _cache;
+    // Data is inserted into cache at front, and read from front.
+    ByteRingBuffer _cache;
+    String _rendered;           // Body read by a _render() that went past maxLength, sent first
+    size_t _renderedSent;
     size_t _readDataFromCacheOrContent(uint8_t* data, const size_t len);
     size_t _fillBufferAndProcessTemplates(uint8_t* buf, size_t maxLen);
+    size_t _fillBufferAndCompress(uint8_t* buf, size_t maxLen);
+    void _beginCompression(AsyncWebServerRequest *request);
 
   protected:
     AwsTemplateProcessor _callback;
+    size_t _compressionWindow;
+    AsyncDeflater* _deflater;
+    size_t _plainLeft;      // Uncompressed bytes still to read when the length was known, else SIZE_MAX
 
   public:
     AsyncAbstractResponse(AwsTemplateProcessor callback = nullptr);
+    ~AsyncAbstractResponse();
+
+    /////////////////////////////////////////////////
+
+    inline void setCompression(size_t windowSize = DEFLATE_WINDOW_SIZE) override
+    {
+      _compressionWindow = windowSize;
+    }
+
+    /////////////////////////////////////////////////
+
     void _respond(AsyncWebServerRequest *request);
     size_t _ack(AsyncWebServerRequest *request, size_t len, uint32_t time);
+    virtual bool _render(uint8_t version, String& out, size_t maxLength) override;
 
     /////////////////////////////////////////////////
 
@@ -143,8 +206,19 @@ class AsyncFileResponse: public AsyncAbstractResponse
     File _content;
     String _path;
     void _setContentType(const String& path);
+    void _setContentEncoding(const String& name, const String& path, bool download);
+    void _applyRange(AsyncWebServerRequest *request);
 
   public:
+    // Open the smallest variant of path the client accepts : path.br, path.gz, then path itself
+    static File openVariant(FS &fs, const String& path, AsyncWebServerRequest *request);
+
+    // From the extension of path, text/plain when unknown
+    static const char* contentTypeFor(const String& path);
+
+    // Adds or overrides a type, e.g. addContentType("wasm", "application/wasm")
+    static void addContentType(const String& extension, const String& type);
+
     AsyncFileResponse(FS &fs, const String& path, const String& contentType = String(), bool download = false,
                       AwsTemplateProcessor callback = nullptr);
     AsyncFileResponse(File content, const String& path, const String& contentType = String(), bool download = false,
@@ -152,6 +226,8 @@ class AsyncFileResponse: public AsyncAbstractResponse
 
     ~AsyncFileResponse();
 
+    void _respond(AsyncWebServerRequest *request);
+
     /////////////////////////////////////////////////
 
     inline bool _sourceValid() const
@@ -184,6 +260,15 @@ class AsyncStreamResponse: public AsyncAbstractResponse
     /////////////////////////////////////////////////
 
     virtual size_t _fillBuffer(uint8_t *buf, size_t maxLen) override;
+
+    /////////////////////////////////////////////////
+
+    // A Stream may not have all its data available yet
+    virtual bool _render(uint8_t version __attribute__((unused)), String& out __attribute__((unused)),
+                         size_t maxLength __attribute__((unused))) override
+    {
+      return false;
+    }
 };
 
 /////////////////////////////////////////////////
@@ -208,6 +293,15 @@ class AsyncCallbackResponse: public AsyncAbstractResponse
     /////////////////////////////////////////////////
 
     virtual size_t _fillBuffer(uint8_t *buf, size_t maxLen) override;
+
+    /////////////////////////////////////////////////
+
+    // The callback may ask to try again later
+    virtual bool _render(uint8_t version __attribute__((unused)), String& out __attribute__((unused)),
+                         size_t maxLength __attribute__((unused))) override
+    {
+      return false;
+    }
 };
 
 /////////////////////////////////////////////////
@@ -232,6 +326,15 @@ class AsyncChunkedResponse: public AsyncAbstractResponse
     /////////////////////////////////////////////////
 
     virtual size_t _fillBuffer(uint8_t *buf, size_t maxLen) override;
+
+    /////////////////////////////////////////////////
+
+    // The callback may ask to try again later
+    virtual bool _render(uint8_t version __attribute__((unused)), String& out __attribute__((unused)),
+                         size_t maxLength __attribute__((unused))) override
+    {
+      return false;
+    }
 };
 
 /////////////////////////////////////////////////
@@ -258,13 +361,116 @@ class AsyncProgmemResponse: public AsyncAbstractResponse
     virtual size_t _fillBuffer(uint8_t *buf, size_t maxLen) override;
 };
 
+/////////////////////////////////////////////////
+
+// JSON of a fixed shape, see AsyncJsonWriter.h. Written once, in the response itself, in at most
+// AsyncJsonWriter<T>::maxLength bytes.
+template<typename T>
+class AsyncTypedJsonResponse: public AsyncAbstractResponse
+{
+  private:
+    char _json[AsyncJsonWriter<T>::maxLength + 1];
+    size_t _readLength;
+
+  public:
+    AsyncTypedJsonResponse(const T& value, int code = 200) : _readLength(0)
+    {
+      _code = code;
+      _contentType = "application/json";
+      _contentLength = AsyncJsonWriter<T>::write(_json, value);
+    }
+
+    /////////////////////////////////////////////////
+
+    inline bool _sourceValid() const
+    {
+      return true;
+    }
+
+    /////////////////////////////////////////////////
+
+    virtual size_t _fillBuffer(uint8_t *buf, size_t maxLen) override
+    {
+      size_t len = _contentLength - _readLength;
+
+      if (len > maxLen)
+        len = maxLen;
+
+      memcpy(buf, _json + _readLength, len);
+      _readLength += len;
+
+      return len;
+    }
+};
+
+/////////////////////////////////////////////////
+
+// Size of the segments AsyncResponseStream content is written into
+#ifndef RESPONSE_STREAM_SEGMENT_SIZE
+  #define RESPONSE_STREAM_SEGMENT_SIZE    512
+#endif
+
+// Free segments kept for reuse, shared by all responses
+#ifndef RESPONSE_STREAM_POOL_SIZE
+  #define RESPONSE_STREAM_POOL_SIZE       8
+#endif
+
+/////////////////////////////////////////////////
+
+typedef struct AwsBufferSegment
+{
+  struct AwsBufferSegment* next;
+  uint8_t data[RESPONSE_STREAM_SEGMENT_SIZE];
+} AwsBufferSegment;
+
+/////////////////////////////////////////////////
+
+// FIFO of bytes in a chain of fixed-size segments : grows without moving what is already written,
+// and gives each segment back to a shared pool as soon as it has been read.
+class SegmentedBuffer
+{
+  private:
+    AwsBufferSegment* _head;
+    AwsBufferSegment* _tail;
+    size_t _readOffset;       // In _head
+    size_t _writeOffset;      // In _tail
+    size_t _size;
+
+    static AwsBufferSegment* _allocSegment();
+    static void _freeSegment(AwsBufferSegment* segment);
+
+  public:
+    SegmentedBuffer(): _head(nullptr), _tail(nullptr), _readOffset(0), _writeOffset(0), _size(0) {}
+    ~SegmentedBuffer();
+
+    SegmentedBuffer(const SegmentedBuffer &) = delete;
+    SegmentedBuffer &operator=(const SegmentedBuffer &) = delete;
+
+    /////////////////////////////////////////////////
+
+    inline size_t size() const
+    {
+      return _size;
+    }
+
+    /////////////////////////////////////////////////
+
+    // Returns bytes stored, less than len only when out of memory
+    size_t write(const uint8_t* data, size_t len);
+
+    // Move up to len bytes from the front into data. Returns bytes read.
+    size_t read(uint8_t* data, size_t len);
+
+    // Drop all content, segments go back to the pool
+    void clear();
+};
 
 /////////////////////////////////////////////////
 
 class AsyncResponseStream: public AsyncAbstractResponse, public Print
 {
   private:
-    cbuf *_content;
+    SegmentedBuffer _content;
 
   public:
     AsyncResponseStream(const String& contentType, size_t bufferSize);
@@ -285,6 +491,236 @@ class AsyncResponseStream: public AsyncAbstractResponse, public Print
     using Print::write;
 };
 
+/////////////////////////////////////////////////
+
+typedef enum
+{
+  AWS_SEGMENT_FLASH,          // PROGMEM / const data, never freed
+  AWS_SEGMENT_RAM_OWNED,      // malloc'ed buffer, freed with the response
+  AWS_SEGMENT_RAM_BORROWED,   // caller's buffer, must stay valid until the response is sent
+  AWS_SEGMENT_STRING,         // String moved into the response
+  AWS_SEGMENT_CALLBACK,       // filled on demand, with a declared length
+  AWS_SEGMENT_SPANS           // spans of the caller's memory, sent without copy and released once acked
+} AwsSegmentType;
+
+/////////////////////////////////////////////////
+
+typedef struct
+{
+  AwsSegmentType type;
+  const uint8_t * data;
+  size_t len;
+  String string;
+  AwsResponseFiller filler;
+  AwsResponseSpanFiller spanFiller;
+  AwsResponseSpanRelease release;
+} AwsResponseSegment;
+
+/////////////////////////////////////////////////
+
+typedef struct
+{
+  AwsResponseSpan span;
+  size_t end;                 // Position of the end of the span in the response, head included
+  size_t segment;
+} AwsPendingSpan;
+
+/////////////////////////////////////////////////
+
+// Response built from an ordered list of fragments, added one after the other to the AsyncClient.
+// Nothing is concatenated : flash fragments are passed to the TCP stack by reference,
+// RAM fragments are copied once, directly from where they live into the TCP stack, except spans.
+class AsyncScatterGatherResponse: public AsyncWebServerResponse
+{
+  private:
+    String _head;
+    size_t _headOffset;
+    std::vector<AwsResponseSegment> _segments;
+    size_t _segmentIndex;
+    size_t _segmentOffset;
+    AwsResponseSpan _span;                  // Span being sent, of _spanLength bytes once truncated to the segment
+    size_t _spanLength;
+    size_t _spanOffset;
+    std::vector<AwsPendingSpan> _unacked;   // Sent spans, in order, waiting for their ack to be released
+    bool _aborted;                          // Connection aborted or reset : unacked spans can be released
+
+    AsyncScatterGatherResponse& _addSegment(AwsSegmentType type, const uint8_t * data, size_t len);
+    size_t _sendSegment(AsyncClient *client, AwsResponseSegment& segment, size_t len);
+    void _releaseSpans(size_t ackedLength);
+
+  public:
+    AsyncScatterGatherResponse(int code, const String& contentType = String());
+    ~AsyncScatterGatherResponse();
+
+    AsyncScatterGatherResponse& addFlash(const uint8_t * content, size_t len);
+    AsyncScatterGatherResponse& addFlash(PGM_P content);
+    AsyncScatterGatherResponse& addOwned(uint8_t * content, size_t len);
+    AsyncScatterGatherResponse& addOwned(String content);
+    AsyncScatterGatherResponse& addBorrowed(const uint8_t * content, size_t len);
+    AsyncScatterGatherResponse& addBorrowed(const char * content);
+    AsyncScatterGatherResponse& addCallback(size_t len, AwsResponseFiller callback);
+    AsyncScatterGatherResponse& addSpans(size_t len, AwsResponseSpanFiller filler, AwsResponseSpanRelease release = nullptr);
+
+    void _respond(AsyncWebServerRequest *request);
+    size_t _ack(AsyncWebServerRequest *request, size_t len, uint32_t time);
+
+    /////////////////////////////////////////////////
+
+    inline bool _sourceValid() const
+    {
+      return true;
+    }
+
+    /////////////////////////////////////////////////
+
+    inline bool _unackedByReference() const
+    {
+      return !_unacked.empty() || (_span.data && _spanOffset);
+    }
+
+    /////////////////////////////////////////////////
+
+    inline void _connectionAborted()
+    {
+      _aborted = true;
+    }
+
+    /////////////////////////////////////////////////
+};
+
+/////////////////////////////////////////////////
+
+// Encodings a request accepts, as far as precompressed variants are concerned
+#define AWS_ACCEPT_GZIP         0x01
+#define AWS_ACCEPT_BR           0x02
+
+/////////////////////////////////////////////////
+
+/*
+   AsyncCachedFile :: Content and response headers of a small static file, kept in RAM by AsyncStaticWebHandler.
+   Reference counted : the handler and each response sending it hold one reference.
+ * */
+
+class AsyncCachedFile
+{
+  private:
+    uint16_t _refs;
+
+  public:
+    String path;          // FS path requested, before Accept-Encoding negotiation
+    uint8_t accept;       // Encodings accepted by the requests this entry serves (AWS_ACCEPT_*)
+    String variant;       // FS path actually read : path, path.gz or path.br
+    size_t size;
+    time_t lastWrite;
+    String etag;
+    String headers;       // Precomputed "Name: value\r\n" lines
+    uint8_t* data;
+    uint32_t checkedAt;   // millis() of the last check against the FS
+    uint32_t usedAt;      // Last use, for LRU eviction
+
+    AsyncCachedFile(): _refs(1), accept(0), size(0), lastWrite(0), data(nullptr), checkedAt(0), usedAt(0) {}
+
+    AsyncCachedFile(const AsyncCachedFile &) = delete;
+    AsyncCachedFile &operator=(const AsyncCachedFile &) = delete;
+
+    /////////////////////////////////////////////////
+
+    inline void retain()
+    {
+      _refs++;
+    }
+
+    /////////////////////////////////////////////////
+
+    inline void release()
+    {
+      if (--_refs == 0)
+        delete this;
+    }
+
+    /////////////////////////////////////////////////
+
+  private:
+    ~AsyncCachedFile()
+    {
+      free(data);
+    }
+};
+
+/////////////////////////////////////////////////
+
+class AsyncCachedFileResponse: public AsyncScatterGatherResponse
+{
+  private:
+    AsyncCachedFile* _file;
+
+  public:
+    AsyncCachedFileResponse(AsyncCachedFile* file);
+    ~AsyncCachedFileResponse();
+
+    virtual String _assembleHead(uint8_t version) override;
+};
+
+/////////////////////////////////////////////////
+
+/*
+   AsyncRenderedEntry :: Response of a GET handler, head and body, kept in RAM by AsyncCallbackWebHandler.
+   Reference counted like AsyncCachedFile.
+ * */
+
+class AsyncRenderedEntry
+{
+  private:
+    uint16_t _refs;
+
+  public:
+    String key;           // HTTP version, URL, then the params and headers the handler varies on
+    String data;          // Head and body, as sent
+    uint32_t storedAt;    // millis(), for the TTL
+
+    AsyncRenderedEntry(): _refs(1), storedAt(0) {}
+
+    AsyncRenderedEntry(const AsyncRenderedEntry &) = delete;
+    AsyncRenderedEntry &operator=(const AsyncRenderedEntry &) = delete;
+
+    /////////////////////////////////////////////////
+
+    inline void retain()
+    {
+      _refs++;
+    }
+
+    /////////////////////////////////////////////////
+
+    inline void release()
+    {
+      if (--_refs == 0)
+        delete this;
+    }
+
+    /////////////////////////////////////////////////
+
+  private:
+    ~AsyncRenderedEntry() {}
+};
+
+/////////////////////////////////////////////////
+
+// Replays an AsyncRenderedEntry : its head is already part of the data
+class AsyncRenderedResponse: public AsyncScatterGatherResponse
+{
+  private:
+    AsyncRenderedEntry* _entry;
+
+  public:
+    AsyncRenderedResponse(AsyncRenderedEntry* entry);
+    ~AsyncRenderedResponse();
+
+    virtual String _assembleHead(uint8_t version) override;
+};
+
+/////////////////////////////////////////////////
+
 }
 
 #endif /* ASYNCWEBSERVERRESPONSEIMPL_H_ */
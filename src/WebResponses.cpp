@@ -41,7 +41,6 @@
 #include "AsyncWebServer_WT32_ETH01.h"
 
 #include "WebResponseImpl.h"
-#include "cbuf.h"
 
 
 namespace eth {
@@ -255,11 +254,35 @@ void AsyncWebServerResponse::addHeader(const String& name, const String& value)
 
 /////////////////////////////////////////////////
 
+bool AsyncWebServerResponse::hasHeader(const String& name) const
+{
+  return getHeader(name) != nullptr;
+}
+
+/////////////////////////////////////////////////
+
+AsyncWebHeader* AsyncWebServerResponse::getHeader(const String& name) const
+{
+  for (const auto& h : _headers)
+  {
+    if (h->name().equalsIgnoreCase(name))
+    {
+      return h;
+    }
+  }
+
+  return nullptr;
+}
+
+/////////////////////////////////////////////////
+
 String AsyncWebServerResponse::_assembleHead(uint8_t version)
 {
   if (version)
   {
-    addHeader("Accept-Ranges", "none");
+    // Responses able to serve byte ranges (e.g. AsyncFileResponse) announce it themselves
+    if (!hasHeader("Accept-Ranges"))
+      addHeader("Accept-Ranges", "none");
 
     if (_chunked)
       addHeader("Transfer-Encoding", "chunked");
@@ -517,6 +540,23 @@ void AsyncBasicResponse::_respond(AsyncWebServerRequest *request)
 
 /////////////////////////////////////////////////
 
+bool AsyncBasicResponse::_render(uint8_t version, String& out, size_t maxLength)
+{
+  if (_contentLength > maxLength)
+    return false;
+
+  out = _assembleHead(version);
+
+  if (_contentCstr)
+    out.concat(_contentCstr, _contentLength);
+  else
+    out.concat(_content);
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+
 size_t AsyncBasicResponse::_ack(AsyncWebServerRequest *request, size_t len, uint32_t time)
 {
   WT32_ETH01_AWS_UNUSED(time);
@@ -637,11 +677,279 @@ size_t AsyncBasicResponse::_ack(AsyncWebServerRequest *request, size_t len, uint
 /////////////////////////////////////////////////
 /////////////////////////////////////////////////
 
+/*
+   Segmented Buffer (AsyncResponseStream content)
+ * */
+
+// Responses may be built by other tasks than AsyncTCP's (deferred responses)
+static portMUX_TYPE segmentPoolLock = portMUX_INITIALIZER_UNLOCKED;
+static AwsBufferSegment* segmentPool = nullptr;
+static uint8_t segmentPoolSize = 0;
+
+/////////////////////////////////////////////////
+
+AwsBufferSegment* SegmentedBuffer::_allocSegment()
+{
+  portENTER_CRITICAL(&segmentPoolLock);
+
+  AwsBufferSegment* segment = segmentPool;
+
+  if (segment)
+  {
+    segmentPool = segment->next;
+    segmentPoolSize--;
+  }
+
+  portEXIT_CRITICAL(&segmentPoolLock);
+
+  if (!segment)
+  {
+    segment = (AwsBufferSegment*) malloc(sizeof(AwsBufferSegment));
+
+    if (!segment)
+    {
+      AWS_LOGERROR(F("[SegmentedBuffer::_allocSegment] Out of memory"));
+
+      return nullptr;
+    }
+  }
+
+  segment->next = nullptr;
+
+  return segment;
+}
+
+/////////////////////////////////////////////////
+
+void SegmentedBuffer::_freeSegment(AwsBufferSegment* segment)
+{
+  portENTER_CRITICAL(&segmentPoolLock);
+
+  const bool pooled = (segmentPoolSize < RESPONSE_STREAM_POOL_SIZE);
+
+  if (pooled)
+  {
+    segment->next = segmentPool;
+    segmentPool = segment;
+    segmentPoolSize++;
+  }
+
+  portEXIT_CRITICAL(&segmentPoolLock);
+
+  if (!pooled)
+    free(segment);
+}
+
+/////////////////////////////////////////////////
+
+SegmentedBuffer::~SegmentedBuffer()
+{
+  clear();
+}
+
+/////////////////////////////////////////////////
+
+void SegmentedBuffer::clear()
+{
+  while (_head)
+  {
+    AwsBufferSegment* next = _head->next;
+
+    _freeSegment(_head);
+    _head = next;
+  }
+
+  _tail = nullptr;
+  _readOffset = 0;
+  _writeOffset = 0;
+  _size = 0;
+}
+
+/////////////////////////////////////////////////
+
+size_t SegmentedBuffer::write(const uint8_t* data, size_t len)
+{
+  size_t written = 0;
+
+  while (written < len)
+  {
+    if (!_tail || _writeOffset == RESPONSE_STREAM_SEGMENT_SIZE)
+    {
+      AwsBufferSegment* segment = _allocSegment();
+
+      if (!segment)
+        break;
+
+      if (_tail)
+        _tail->next = segment;
+      else
+        _head = segment;
+
+      _tail = segment;
+      _writeOffset = 0;
+    }
+
+    const size_t chunk = std::min(len - written, (size_t) RESPONSE_STREAM_SEGMENT_SIZE - _writeOffset);
+
+    memcpy(_tail->data + _writeOffset, data + written, chunk);
+    _writeOffset += chunk;
+    written += chunk;
+  }
+
+  _size += written;
+
+  return written;
+}
+
+/////////////////////////////////////////////////
+
+size_t SegmentedBuffer::read(uint8_t* data, size_t len)
+{
+  size_t readLen = 0;
+
+  while (readLen < len && _size)
+  {
+    // Bytes of _head holding data : up to _writeOffset for the last segment
+    const size_t end = (_head == _tail) ? _writeOffset : RESPONSE_STREAM_SEGMENT_SIZE;
+    const size_t chunk = std::min(len - readLen, end - _readOffset);
+
+    memcpy(data + readLen, _head->data + _readOffset, chunk);
+    _readOffset += chunk;
+    readLen += chunk;
+    _size -= chunk;
+
+    if (_readOffset == end)
+    {
+      AwsBufferSegment* next = _head->next;
+
+      _freeSegment(_head);
+      _head = next;
+      _readOffset = 0;
+
+      if (!_head)
+      {
+        _tail = nullptr;
+        _writeOffset = 0;
+      }
+    }
+  }
+
+  return readLen;
+}
+
+/////////////////////////////////////////////////
+/////////////////////////////////////////////////
+
+/*
+   Byte Ring Buffer (template lookahead cache)
+ * */
+
+#define BYTE_RING_BUFFER_MIN_CAPACITY     64
+
+ByteRingBuffer::~ByteRingBuffer()
+{
+  if (_buf)
+    free(_buf);
+}
+
+/////////////////////////////////////////////////
+
+void ByteRingBuffer::_copyOut(uint8_t* data, size_t len) const
+{
+  // Content may wrap around the end of the buffer : copy in (at most) two pieces
+  const size_t firstPart = std::min(len, _capacity - _head);
+
+  memcpy(data, _buf + _head, firstPart);
+
+  if (len > firstPart)
+    memcpy(data + firstPart, _buf, len - firstPart);
+}
+
+/////////////////////////////////////////////////
+
+bool ByteRingBuffer::_reserve(size_t capacity)
+{
+  if (capacity <= _capacity)
+    return true;
+
+  size_t newCapacity = _capacity ? _capacity : BYTE_RING_BUFFER_MIN_CAPACITY;
+
+  while (newCapacity < capacity)
+    newCapacity <<= 1;
+
+  uint8_t* newBuf = (uint8_t*)malloc(newCapacity);
+
+  if (!newBuf)
+  {
+    AWS_LOGERROR1(F("[ByteRingBuffer::_reserve] malloc failed, size ="), newCapacity);
+
+    return false;
+  }
+
+  // Linearize existing content at the start of the new buffer
+  if (_size)
+    _copyOut(newBuf, _size);
+
+  if (_buf)
+    free(_buf);
+
+  _buf = newBuf;
+  _capacity = newCapacity;
+  _head = 0;
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+
+size_t ByteRingBuffer::pushFront(const uint8_t* data, size_t len)
+{
+  if (!len || !_reserve(_size + len))
+    return 0;
+
+  _head = (_head + _capacity - len) % _capacity;
+
+  const size_t firstPart = std::min(len, _capacity - _head);
+
+  memcpy(_buf + _head, data, firstPart);
+
+  if (len > firstPart)
+    memcpy(_buf, data + firstPart, len - firstPart);
+
+  _size += len;
+
+  return len;
+}
+
+/////////////////////////////////////////////////
+
+size_t ByteRingBuffer::popFront(uint8_t* data, size_t len)
+{
+  len = std::min(len, _size);
+
+  if (!len)
+    return 0;
+
+  _copyOut(data, len);
+
+  _head = (_head + len) % _capacity;
+  _size -= len;
+
+  if (!_size)
+    _head = 0;
+
+  return len;
+}
+
+/////////////////////////////////////////////////
+/////////////////////////////////////////////////
+
 /*
    Abstract Response
  * */
 
-AsyncAbstractResponse::AsyncAbstractResponse(AwsTemplateProcessor callback): _callback(callback)
+AsyncAbstractResponse::AsyncAbstractResponse(AwsTemplateProcessor callback): _renderedSent(0), _callback(callback),
+  _compressionWindow(0), _deflater(nullptr), _plainLeft(SIZE_MAX)
 {
   // In case of template processing, we're unable to determine real response size
   if (callback)
@@ -654,8 +962,63 @@ AsyncAbstractResponse::AsyncAbstractResponse(AwsTemplateProcessor callback): _ca
 
 /////////////////////////////////////////////////
 
+AsyncAbstractResponse::~AsyncAbstractResponse()
+{
+  delete _deflater;
+}
+
+/////////////////////////////////////////////////
+
+void AsyncAbstractResponse::_beginCompression(AsyncWebServerRequest *request)
+{
+  if (!_compressionWindow || _code < 200 || _code == 204 || _code == 304
+      || hasHeader("Content-Encoding") || hasHeader("Content-Range"))
+    return;
+
+  addHeader("Vary", "Accept-Encoding");
+
+  AwsContentEncoding encoding;
+
+  if (request->acceptsEncoding("gzip"))
+    encoding = AWS_ENCODING_GZIP;
+  else if (request->acceptsEncoding("deflate"))
+    encoding = AWS_ENCODING_DEFLATE;
+  else
+    return;
+
+  _deflater = new AsyncDeflater(encoding, _compressionWindow);
+
+  if (!_deflater->valid())
+  {
+    // Not enough heap, send uncompressed
+    delete _deflater;
+    _deflater = nullptr;
+
+    return;
+  }
+
+  addHeader("Content-Encoding", (encoding == AWS_ENCODING_GZIP) ? "gzip" : "deflate");
+
+  // Compressed size is unknown : chunked for HTTP/1.1, until close for HTTP/1.0
+  if (_sendContentLength)
+    _plainLeft = _contentLength;
+
+  _sendContentLength = false;
+  _chunked = request->version();
+}
+
+/////////////////////////////////////////////////
+
 void AsyncAbstractResponse::_respond(AsyncWebServerRequest *request)
 {
+  // A failed _render() consumed part of the content : nothing sound can be sent anymore
+  if (_failed())
+  {
+    request->client()->abort();
+    return;
+  }
+
+  _beginCompression(request);
   addHeader("Connection", "close");
   _head = _assembleHead(request->version());
   _state = RESPONSE_HEADERS;
@@ -664,6 +1027,57 @@ void AsyncAbstractResponse::_respond(AsyncWebServerRequest *request)
 
 /////////////////////////////////////////////////
 
+// Templates are processed, compression is not applied : the body is rendered once, for any client.
+// A body of unknown length is read up to maxLength + 1 bytes ; past maxLength, what was read is kept and
+// sent first, and the response goes on as if _render() hadn't been called
+bool AsyncAbstractResponse::_render(uint8_t version, String& out, size_t maxLength)
+{
+  const size_t expected = (_sendContentLength && !_callback) ? _contentLength : SIZE_MAX;
+
+  if (expected != SIZE_MAX && expected > maxLength)
+    return false;
+
+  const size_t limit = (expected != SIZE_MAX) ? expected : (maxLength == SIZE_MAX) ? SIZE_MAX : maxLength + 1;
+  uint8_t buf[256];
+  String body;
+
+  if (expected != SIZE_MAX)
+    body.reserve(expected);
+
+  while (body.length() < limit)
+  {
+    size_t readLen = _fillBufferAndProcessTemplates(buf, std::min(sizeof(buf), limit - body.length()));
+
+    if (!readLen || readLen == RESPONSE_TRY_AGAIN)
+      break;
+
+    body.concat((const char *) buf, readLen);
+  }
+
+  if (_failed())
+    return false;
+
+  if (body.length() > maxLength)
+  {
+    _rendered = std::move(body);
+    _renderedSent = 0;
+
+    return false;
+  }
+
+  _contentLength = body.length();
+  _sendContentLength = true;
+  _chunked = false;
+
+  addHeader("Connection", "close");
+  out = _assembleHead(version);
+  out.concat(body);
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+
 size_t AsyncAbstractResponse::_ack(AsyncWebServerRequest *request, size_t len, uint32_t time)
 {
   WT32_ETH01_AWS_UNUSED(time);
@@ -739,7 +1153,7 @@ size_t AsyncAbstractResponse::_ack(AsyncWebServerRequest *request, size_t len, u
     {
       // HTTP 1.1 allows leading zeros in chunk length. Or spaces may be added.
       // See RFC2616 sections 2, 3.6.1.
-      readLen = _fillBufferAndProcessTemplates(buf + headLen + 6, outLen - 8);
+      readLen = _fillBufferAndCompress(buf + headLen + 6, outLen - 8);
 
       if (readLen == RESPONSE_TRY_AGAIN)
       {
@@ -760,7 +1174,7 @@ size_t AsyncAbstractResponse::_ack(AsyncWebServerRequest *request, size_t len, u
     }
     else
     {
-      readLen = _fillBufferAndProcessTemplates(buf + headLen, outLen);
+      readLen = _fillBufferAndCompress(buf + headLen, outLen);
 
       if (readLen == RESPONSE_TRY_AGAIN)
       {
@@ -771,6 +1185,15 @@ size_t AsyncAbstractResponse::_ack(AsyncWebServerRequest *request, size_t len, u
       outLen = readLen + headLen;
     }
 
+    // Content lost while processing templates : a truncated page must not look complete
+    if (_failed())
+    {
+      free(buf);
+      request->client()->abort();
+
+      return 0;
+    }
+
     if (headLen)
     {
       _head = String();
@@ -816,17 +1239,59 @@ size_t AsyncAbstractResponse::_ack(AsyncWebServerRequest *request, size_t len, u
 
 /////////////////////////////////////////////////
 
-size_t AsyncAbstractResponse::_readDataFromCacheOrContent(uint8_t* data, const size_t len)
+// Pull plain content through the deflater until maxLen compressed bytes are ready, or the end is reached
+size_t AsyncAbstractResponse::_fillBufferAndCompress(uint8_t* data, size_t len)
 {
-  // If we have something in cache, copy it to buffer
-  const size_t readFromCache = std::min(len, _cache.size());
+  if (!_deflater)
+    return _fillBufferAndProcessTemplates(data, len);
+
+  size_t written = _deflater->read(data, len);
 
-  if (readFromCache)
+  while (written < len && !_deflater->finished())
   {
-    memcpy(data, _cache.data(), readFromCache);
-    _cache.erase(_cache.begin(), _cache.begin() + readFromCache);
+    size_t space;
+    uint8_t* input = _deflater->inputBuffer(space);
+
+    if (space > _plainLeft)
+      space = _plainLeft;
+
+    if (input && space)
+    {
+      const size_t readLen = _fillBufferAndProcessTemplates(input, space);
+
+      if (readLen == RESPONSE_TRY_AGAIN)
+        return written ? written : RESPONSE_TRY_AGAIN;
+
+      if (readLen)
+      {
+        _deflater->commit(readLen);
+
+        if (_plainLeft != SIZE_MAX)
+          _plainLeft -= readLen;
+      }
+      else
+      {
+        _deflater->finish();
+      }
+    }
+    else
+    {
+      _deflater->finish();
+    }
+
+    written += _deflater->read(data + written, len - written);
   }
 
+  return written;
+}
+
+/////////////////////////////////////////////////
+
+size_t AsyncAbstractResponse::_readDataFromCacheOrContent(uint8_t* data, const size_t len)
+{
+  // If we have something in cache, copy it to buffer
+  const size_t readFromCache = _cache.popFront(data, len);
+
   // If we need to read more...
   const size_t needFromFile = len - readFromCache;
   const size_t readFromContent = _fillBuffer(data + readFromCache, needFromFile);
@@ -838,12 +1303,43 @@ size_t AsyncAbstractResponse::_readDataFromCacheOrContent(uint8_t* data, const s
 
 size_t AsyncAbstractResponse::_fillBufferAndProcessTemplates(uint8_t* data, size_t len)
 {
-  if (!_callback)
-    return _fillBuffer(data, len);
+  // What an unsuccessful _render() already read
+  if (_renderedSent < _rendered.length())
+  {
+    const size_t left = _rendered.length() - _renderedSent;
+    const size_t readLen = (len < left) ? len : left;
+
+    memcpy(data, _rendered.c_str() + _renderedSent, readLen);
+    _renderedSent += readLen;
+
+    if (_renderedSent == _rendered.length())
+    {
+      _rendered = String();
+      _renderedSent = 0;
+    }
+
+    return readLen;
+  }
+
+  if (!_callback)
+    return _fillBuffer(data, len);
 
   const size_t originalLen = len;
   len = _readDataFromCacheOrContent(data, len);
 
+  // Read-ahead bytes put back in the cache : if they can't be, the page would silently miss them
+  auto keepInCache = [this](const uint8_t* bytes, size_t count)
+  {
+    if (!count || _cache.pushFront(bytes, count) == count)
+      return true;
+
+    AWS_LOGERROR1(F("[AsyncAbstractResponse::_fillBufferAndProcessTemplates] can't cache, size ="), count);
+
+    _state = RESPONSE_FAILED;
+
+    return false;
+  };
+
   // Now we've read 'len' bytes, either from cache or from file
   // Search for template placeholders
   uint8_t* pTemplateStart = data;
@@ -898,14 +1394,17 @@ size_t AsyncAbstractResponse::_fillBufferAndProcessTemplates(uint8_t* data, size
           paramName = String(reinterpret_cast<char*>(buf));
 
           // Copy remaining read-ahead data into cache
-          _cache.insert(_cache.begin(), pTemplateEnd + 1, buf + (&data[len - 1] - pTemplateStart) + readFromCacheOrContent);
+          if (!keepInCache(pTemplateEnd + 1, buf + (&data[len - 1] - pTemplateStart) + readFromCacheOrContent - pTemplateEnd - 1))
+            return 0;
+
           pTemplateEnd = &data[len - 1];
         }
         else // closing placeholder not found in file data, store found percent symbol as is and advance to the next position
         {
           // but first, store read file data in cache
-          _cache.insert(_cache.begin(), buf + (&data[len - 1] - pTemplateStart),
-                        buf + (&data[len - 1] - pTemplateStart) + readFromCacheOrContent);
+          if (!keepInCache(buf + (&data[len - 1] - pTemplateStart), readFromCacheOrContent))
+            return 0;
+
           ++pTemplateStart;
         }
       }
@@ -932,7 +1431,11 @@ size_t AsyncAbstractResponse::_fillBufferAndProcessTemplates(uint8_t* data, size
       if ((pTemplateEnd + 1 < pTemplateStart + numBytesCopied)
           && (originalLen - (pTemplateStart + numBytesCopied - pTemplateEnd - 1) < len))
       {
-        _cache.insert(_cache.begin(), &data[originalLen - (pTemplateStart + numBytesCopied - pTemplateEnd - 1)], &data[len]);
+        const size_t overflowStart = originalLen - (pTemplateStart + numBytesCopied - pTemplateEnd - 1);
+
+        if (!keepInCache(&data[overflowStart], len - overflowStart))
+          return 0;
+
         //2. parameter value is longer than placeholder text, push the data after placeholder which not saved into cache further to the end
         memmove(pTemplateStart + numBytesCopied, pTemplateEnd + 1, &data[originalLen] - pTemplateStart - numBytesCopied);
         len = originalLen; // fix issue with truncated data, not sure if it has any side effects
@@ -948,7 +1451,8 @@ size_t AsyncAbstractResponse::_fillBufferAndProcessTemplates(uint8_t* data, size
       // If result is longer than buffer, copy the remainder into cache (this could happen only if placeholder text itself did not fit entirely in buffer)
       if (numBytesCopied < pvlen)
       {
-        _cache.insert(_cache.begin(), pvstr + numBytesCopied, pvstr + pvlen);
+        if (!keepInCache((const uint8_t*)pvstr + numBytesCopied, pvlen - numBytesCopied))
+          return 0;
       }
       else if (pTemplateStart + numBytesCopied < pTemplateEnd + 1)
       {
@@ -985,46 +1489,176 @@ AsyncFileResponse::~AsyncFileResponse()
 
 /////////////////////////////////////////////////
 
+// Sorted on extension, for a binary search
+static const struct
+{
+  const char* extension;
+  const char* type;
+} contentTypes[] =
+{
+  { "css",    "text/css" },
+  { "eot",    "font/eot" },
+  { "gif",    "image/gif" },
+  { "gz",     "application/x-gzip" },
+  { "htm",    "text/html" },
+  { "html",   "text/html" },
+  { "ico",    "image/x-icon" },
+  { "jpeg",   "image/jpeg" },
+  { "jpg",    "image/jpeg" },
+  { "js",     "application/javascript" },
+  { "json",   "application/json" },
+  { "mjs",    "application/javascript" },
+  { "pdf",    "application/pdf" },
+  { "png",    "image/png" },
+  { "svg",    "image/svg+xml" },
+  { "ttf",    "font/ttf" },
+  { "txt",    "text/plain" },
+  { "wasm",   "application/wasm" },
+  { "webp",   "image/webp" },
+  { "woff",   "font/woff" },
+  { "woff2",  "font/woff2" },
+  { "xml",    "text/xml" },
+  { "zip",    "application/zip" },
+};
+
+/////////////////////////////////////////////////
+
+// Registered by the application, searched before the built-in table
+static LinkedList<AsyncWebHeader *>& customContentTypes()
+{
+  static LinkedList<AsyncWebHeader *> types([](AsyncWebHeader * h)
+  {
+    delete h;
+  });
+
+  return types;
+}
+
+/////////////////////////////////////////////////
+
+void AsyncFileResponse::addContentType(const String& extension, const String& type)
+{
+  const String name = extension.startsWith(".") ? extension.substring(1) : extension;
+
+  customContentTypes().remove_first([&](AsyncWebHeader * h)
+  {
+    return name.equalsIgnoreCase(h->name());
+  });
+
+  customContentTypes().add(new AsyncWebHeader(name, type));
+}
+
+/////////////////////////////////////////////////
+
+const char* AsyncFileResponse::contentTypeFor(const String& path)
+{
+  const int dot = path.lastIndexOf('.');
+
+  // No extension, or a dot in a directory name
+  if ( (dot < 0) || (path.indexOf('/', dot) >= 0) )
+    return "text/plain";
+
+  const char* extension = path.c_str() + dot + 1;
+
+  for (const auto& h : customContentTypes())
+  {
+    if (strcasecmp(extension, h->name().c_str()) == 0)
+      return h->value().c_str();
+  }
+
+  size_t low = 0;
+  size_t high = sizeof(contentTypes) / sizeof(contentTypes[0]);
+
+  while (low < high)
+  {
+    const size_t middle = (low + high) / 2;
+    const int order = strcasecmp(extension, contentTypes[middle].extension);
+
+    if (order == 0)
+      return contentTypes[middle].type;
+
+    if (order < 0)
+      high = middle;
+    else
+      low = middle + 1;
+  }
+
+  return "text/plain";
+}
+
+/////////////////////////////////////////////////
+
 void AsyncFileResponse::_setContentType(const String& path)
 {
-  if (path.endsWith(".html"))
-    _contentType = "text/html";
-  else if (path.endsWith(".htm"))
-    _contentType = "text/html";
-  else if (path.endsWith(".css"))
-    _contentType = "text/css";
-  else if (path.endsWith(".json"))
-    _contentType = "application/json";
-  else if (path.endsWith(".js"))
-    _contentType = "application/javascript";
-  else if (path.endsWith(".png"))
-    _contentType = "image/png";
-  else if (path.endsWith(".gif"))
-    _contentType = "image/gif";
-  else if (path.endsWith(".jpg"))
-    _contentType = "image/jpeg";
-  else if (path.endsWith(".ico"))
-    _contentType = "image/x-icon";
-  else if (path.endsWith(".svg"))
-    _contentType = "image/svg+xml";
-  else if (path.endsWith(".eot"))
-    _contentType = "font/eot";
-  else if (path.endsWith(".woff"))
-    _contentType = "font/woff";
-  else if (path.endsWith(".woff2"))
-    _contentType = "font/woff2";
-  else if (path.endsWith(".ttf"))
-    _contentType = "font/ttf";
-  else if (path.endsWith(".xml"))
-    _contentType = "text/xml";
-  else if (path.endsWith(".pdf"))
-    _contentType = "application/pdf";
-  else if (path.endsWith(".zip"))
-    _contentType = "application/zip";
-  else if (path.endsWith(".gz"))
-    _contentType = "application/x-gzip";
+  _contentType = contentTypeFor(path);
+}
+
+/////////////////////////////////////////////////
+
+#define FILE_IS_REAL(f) (f == true && !f.isDirectory())
+
+/////////////////////////////////////////////////
+
+File AsyncFileResponse::openVariant(FS &fs, const String& path, AsyncWebServerRequest *request)
+{
+  static const char* const encodings[] = { "br", "gzip" };
+  static const char* const suffixes[]  = { ".br", ".gz" };
+
+  File file;
+
+  if (request)
+  {
+    for (size_t i = 0; i < sizeof(suffixes) / sizeof(suffixes[0]); i++)
+    {
+      if (request->acceptsEncoding(encodings[i]))
+      {
+        file = fs.open(path + suffixes[i], "r");
+
+        if (FILE_IS_REAL(file))
+          return file;
+      }
+    }
+  }
+
+  file = fs.open(path, "r");
+
+  if (FILE_IS_REAL(file))
+    return file;
+
+  // Without identity, path.gz has always been served : keep it for clients not announcing gzip
+  if (!request || !request->acceptsEncoding("gzip"))
+  {
+    file = fs.open(path + ".gz", "r");
+
+    if (FILE_IS_REAL(file))
+      return file;
+  }
+
+  return File();
+}
+
+/////////////////////////////////////////////////
+
+// A precompressed variant (path.gz, path.br) is sent as is, with the matching Content-Encoding
+void AsyncFileResponse::_setContentEncoding(const String& name, const String& path, bool download)
+{
+  const char* encoding = nullptr;
+
+  if (download)
+    return;
+
+  if (name.endsWith(".gz") && !path.endsWith(".gz"))
+    encoding = "gzip";
+  else if (name.endsWith(".br") && !path.endsWith(".br"))
+    encoding = "br";
   else
-    _contentType = "text/plain";
+    return;
+
+  addHeader("Content-Encoding", encoding);
+  addHeader("Vary", "Accept-Encoding");
+  _callback = nullptr; // Unable to process compressed templates
+  _sendContentLength = true;
+  _chunked = false;
 }
 
 /////////////////////////////////////////////////
@@ -1035,16 +1669,9 @@ AsyncFileResponse::AsyncFileResponse(FS &fs, const String& path, const String& c
   _code = 200;
   _path = path;
 
-  if (!download && !fs.exists(_path) && fs.exists(_path + ".gz"))
-  {
-    _path = _path + ".gz";
-    addHeader("Content-Encoding", "gzip");
-    _callback = nullptr; // Unable to process zipped templates
-    _sendContentLength = true;
-    _chunked = false;
-  }
-
-  _content = fs.open(_path, "r");
+  // No request to negotiate with : path itself, or path.gz if path does not exist
+  _content = download ? fs.open(_path, "r") : openVariant(fs, _path, nullptr);
+  _setContentEncoding(String(_content.name()), path, download);
   _contentLength = _content.size();
 
   if (contentType == "")
@@ -1078,13 +1705,7 @@ AsyncFileResponse::AsyncFileResponse(File content, const String& path, const Str
   _code = 200;
   _path = path;
 
-  if (!download && String(content.name()).endsWith(".gz") && !path.endsWith(".gz"))
-  {
-    addHeader("Content-Encoding", "gzip");
-    _callback = nullptr; // Unable to process gzipped templates
-    _sendContentLength = true;
-    _chunked = false;
-  }
+  _setContentEncoding(String(content.name()), path, download);
 
   _content = content;
   _contentLength = _content.size();
@@ -1112,6 +1733,156 @@ AsyncFileResponse::AsyncFileResponse(File content, const String& path, const Str
 
 /////////////////////////////////////////////////
 
+typedef enum
+{
+  RANGE_IGNORED,          // absent, malformed or multiple ranges : send the whole file
+  RANGE_SATISFIABLE,
+  RANGE_NOT_SATISFIABLE
+} AwsRangeResult;
+
+/////////////////////////////////////////////////
+
+static bool parseRangeNumber(const char* str, size_t len, size_t& value)
+{
+  if (!len)
+    return false;
+
+  value = 0;
+
+  for (size_t i = 0; i < len; i++)
+  {
+    if (str[i] < '0' || str[i] > '9')
+      return false;
+
+    const size_t digit = str[i] - '0';
+
+    // Saturates : a position past any file size (32 bits size_t) must not wrap to a small one
+    value = (value > (SIZE_MAX - digit) / 10) ? SIZE_MAX : value * 10 + digit;
+  }
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+
+// Parse a single "bytes=first-last", "bytes=first-" or "bytes=-suffix" range (RFC 7233)
+static AwsRangeResult parseRange(const String& range, size_t size, size_t& first, size_t& last)
+{
+  if (!range.startsWith("bytes=") || range.indexOf(',') >= 0)
+    return RANGE_IGNORED;
+
+  const char* spec = range.c_str() + 6;
+  const char* dash = strchr(spec, '-');
+
+  if (!dash)
+    return RANGE_IGNORED;
+
+  size_t firstLen = dash - spec;
+  size_t lastLen  = strlen(dash + 1);
+
+  if (firstLen == 0)
+  {
+    size_t suffix;
+
+    if (!parseRangeNumber(dash + 1, lastLen, suffix))
+      return RANGE_IGNORED;
+
+    if (suffix == 0 || size == 0)
+      return RANGE_NOT_SATISFIABLE;
+
+    first = (suffix < size) ? size - suffix : 0;
+    last  = size - 1;
+
+    return RANGE_SATISFIABLE;
+  }
+
+  if (!parseRangeNumber(spec, firstLen, first))
+    return RANGE_IGNORED;
+
+  if (lastLen == 0)
+    last = size - 1;
+  else if (!parseRangeNumber(dash + 1, lastLen, last) || last < first)
+    return RANGE_IGNORED;
+
+  if (first >= size)
+    return RANGE_NOT_SATISFIABLE;
+
+  if (last >= size)
+    last = size - 1;
+
+  return RANGE_SATISFIABLE;
+}
+
+/////////////////////////////////////////////////
+
+void AsyncFileResponse::_applyRange(AsyncWebServerRequest *request)
+{
+  // If-Range : only send the range if the client's validator still matches the file.
+  // Strong comparison : a weak ETag (not derived from the content) never matches
+  if (request->hasHeader("If-Range"))
+  {
+    const String& validator = request->header("If-Range");
+    AsyncWebHeader* etag = getHeader("ETag");
+    AsyncWebHeader* lastModified = getHeader("Last-Modified");
+    bool strongMatch = etag && !validator.startsWith("W/") && etag->value() == validator;
+
+    if (!strongMatch && !(lastModified && lastModified->value() == validator))
+      return;
+  }
+
+  const size_t size = _contentLength;
+  size_t first = 0;
+  size_t last = 0;
+  char buf[48];
+
+  switch (parseRange(request->header("Range"), size, first, last))
+  {
+    case RANGE_SATISFIABLE:
+      if (!_content.seek(first, fs::SeekSet))
+        return;
+
+      _code = 206;
+      _contentLength = last - first + 1;
+
+      snprintf(buf, sizeof(buf), "bytes %u-%u/%u", first, last, size);
+      addHeader("Content-Range", buf);
+
+      AWS_LOGDEBUG1("AsyncFileResponse::_applyRange : Content-Range =", buf);
+
+      break;
+
+    case RANGE_NOT_SATISFIABLE:
+      _code = 416;
+      _contentLength = 0;
+
+      snprintf(buf, sizeof(buf), "bytes */%u", size);
+      addHeader("Content-Range", buf);
+
+      break;
+
+    default:
+      break;
+  }
+}
+
+/////////////////////////////////////////////////
+
+void AsyncFileResponse::_respond(AsyncWebServerRequest *request)
+{
+  // Ranges are only served on the raw file : template processing and compression change the length
+  if (!_callback && !_compressionWindow && _code == 200)
+  {
+    addHeader("Accept-Ranges", "bytes");
+
+    if (request->hasHeader("Range"))
+      _applyRange(request);
+  }
+
+  AsyncAbstractResponse::_respond(request);
+}
+
+/////////////////////////////////////////////////
+
 size_t AsyncFileResponse::_fillBuffer(uint8_t *data, size_t len)
 {
   return _content.read(data, len);
@@ -1258,26 +2029,25 @@ size_t AsyncProgmemResponse::_fillBuffer(uint8_t *data, size_t len)
    Response Stream (You can print/write/printf to it, up to the contentLen bytes)
  * */
 
-AsyncResponseStream::AsyncResponseStream(const String& contentType, size_t bufferSize)
+// bufferSize is kept for compatibility : content grows by RESPONSE_STREAM_SEGMENT_SIZE bytes segments
+AsyncResponseStream::AsyncResponseStream(const String& contentType, size_t bufferSize __attribute__((unused)))
 {
   _code = 200;
   _contentLength = 0;
   _contentType = contentType;
-  _content = new cbuf(bufferSize);
 }
 
 /////////////////////////////////////////////////
 
 AsyncResponseStream::~AsyncResponseStream()
 {
-  delete _content;
 }
 
 /////////////////////////////////////////////////
 
 size_t AsyncResponseStream::_fillBuffer(uint8_t *buf, size_t maxLen)
 {
-  return _content->read((char*)buf, maxLen);
+  return _content.read(buf, maxLen);
 }
 
 /////////////////////////////////////////////////
@@ -1287,13 +2057,7 @@ size_t AsyncResponseStream::write(const uint8_t *data, size_t len)
   if (_started())
     return 0;
 
-  if (len > _content->room())
-  {
-    size_t needed = len - _content->room();
-    _content->resizeAdd(needed);
-  }
-
-  size_t written = _content->write((const char*)data, len);
+  size_t written = _content.write(data, len);
   _contentLength += written;
 
   return written;
@@ -1306,6 +2070,438 @@ size_t AsyncResponseStream::write(uint8_t data)
   return write(&data, 1);
 }
 
+/////////////////////////////////////////////////
+/////////////////////////////////////////////////
+
+/*
+   Scatter-Gather Response (fragments from flash, RAM or callbacks, sent without concatenation)
+ * */
+
+AsyncScatterGatherResponse::AsyncScatterGatherResponse(int code, const String& contentType)
+  : _headOffset(0)
+  , _segmentIndex(0)
+  , _segmentOffset(0)
+  , _span{nullptr, 0}
+  , _spanLength(0)
+  , _spanOffset(0)
+  , _aborted(false)
+{
+  _code = code;
+  _contentType = contentType;
+  _contentLength = 0;
+}
+
+/////////////////////////////////////////////////
+
+AsyncScatterGatherResponse::~AsyncScatterGatherResponse()
+{
+  // After a graceful close, lwIP keeps the pcb and may still retransmit what is unacked :
+  // those spans are only released if the connection was aborted, never while they may be referenced
+  if (_aborted)
+    _releaseSpans(SIZE_MAX);
+  else if (_unackedByReference())
+    AWS_LOGERROR1(F("[AsyncScatterGatherResponse::~AsyncScatterGatherResponse] Closed with spans unacked, not released, count ="), _unacked.size());
+
+  if (_span.data && _segments[_segmentIndex].release && (_aborted || !_spanOffset))
+    _segments[_segmentIndex].release(_span.data, _span.len);
+
+  for (auto& segment : _segments)
+  {
+    if (segment.type == AWS_SEGMENT_RAM_OWNED && segment.data)
+      free((void *) segment.data);
+  }
+}
+
+/////////////////////////////////////////////////
+
+AsyncScatterGatherResponse& AsyncScatterGatherResponse::_addSegment(AwsSegmentType type, const uint8_t * data,
+                                                                    size_t len)
+{
+  if (_started())
+  {
+    AWS_LOGERROR(F("[AsyncScatterGatherResponse::_addSegment] Response already started"));
+
+    if (type == AWS_SEGMENT_RAM_OWNED && data)
+      free((void *) data);
+
+    return *this;
+  }
+
+  AwsResponseSegment segment;
+
+  segment.type = type;
+  segment.data = data;
+  segment.len  = len;
+
+  _segments.push_back(std::move(segment));
+  _contentLength += len;
+
+  return *this;
+}
+
+/////////////////////////////////////////////////
+
+AsyncScatterGatherResponse& AsyncScatterGatherResponse::addFlash(const uint8_t * content, size_t len)
+{
+  return _addSegment(AWS_SEGMENT_FLASH, content, len);
+}
+
+/////////////////////////////////////////////////
+
+AsyncScatterGatherResponse& AsyncScatterGatherResponse::addFlash(PGM_P content)
+{
+  return addFlash((const uint8_t *) content, strlen_P(content));
+}
+
+/////////////////////////////////////////////////
+
+AsyncScatterGatherResponse& AsyncScatterGatherResponse::addOwned(uint8_t * content, size_t len)
+{
+  return _addSegment(AWS_SEGMENT_RAM_OWNED, content, len);
+}
+
+/////////////////////////////////////////////////
+
+AsyncScatterGatherResponse& AsyncScatterGatherResponse::addOwned(String content)
+{
+  if (_started())
+    return _addSegment(AWS_SEGMENT_STRING, nullptr, 0);
+
+  // Data pointer is taken from the String at send time, as moving a String may move its content
+  size_t len = content.length();
+
+  _addSegment(AWS_SEGMENT_STRING, nullptr, len);
+  _segments.back().string = std::move(content);
+
+  return *this;
+}
+
+/////////////////////////////////////////////////
+
+AsyncScatterGatherResponse& AsyncScatterGatherResponse::addBorrowed(const uint8_t * content, size_t len)
+{
+  return _addSegment(AWS_SEGMENT_RAM_BORROWED, content, len);
+}
+
+/////////////////////////////////////////////////
+
+AsyncScatterGatherResponse& AsyncScatterGatherResponse::addBorrowed(const char * content)
+{
+  return addBorrowed((const uint8_t *) content, strlen(content));
+}
+
+/////////////////////////////////////////////////
+
+AsyncScatterGatherResponse& AsyncScatterGatherResponse::addCallback(size_t len, AwsResponseFiller callback)
+{
+  _addSegment(AWS_SEGMENT_CALLBACK, nullptr, len);
+
+  if (!_started())
+    _segments.back().filler = callback;
+
+  return *this;
+}
+
+/////////////////////////////////////////////////
+
+AsyncScatterGatherResponse& AsyncScatterGatherResponse::addSpans(size_t len, AwsResponseSpanFiller filler,
+                                                                 AwsResponseSpanRelease release)
+{
+  _addSegment(AWS_SEGMENT_SPANS, nullptr, len);
+
+  if (!_started())
+  {
+    _segments.back().spanFiller = filler;
+    _segments.back().release = release;
+  }
+
+  return *this;
+}
+
+/////////////////////////////////////////////////
+
+void AsyncScatterGatherResponse::_releaseSpans(size_t ackedLength)
+{
+  size_t released = 0;
+
+  while (released < _unacked.size() && _unacked[released].end <= ackedLength)
+  {
+    AwsPendingSpan& pending = _unacked[released++];
+
+    if (_segments[pending.segment].release)
+      _segments[pending.segment].release(pending.span.data, pending.span.len);
+  }
+
+  if (released)
+    _unacked.erase(_unacked.begin(), _unacked.begin() + released);
+}
+
+/////////////////////////////////////////////////
+
+void AsyncScatterGatherResponse::_respond(AsyncWebServerRequest *request)
+{
+  addHeader("Connection", "close");
+  _head = _assembleHead(request->version());
+  _state = RESPONSE_HEADERS;
+  _ack(request, 0, 0);
+}
+
+/////////////////////////////////////////////////
+
+size_t AsyncScatterGatherResponse::_sendSegment(AsyncClient *client, AwsResponseSegment& segment, size_t len)
+{
+  switch (segment.type)
+  {
+    case AWS_SEGMENT_FLASH:
+      // Flash content lives forever, let the TCP stack reference it instead of copying
+      return client->add((const char *) segment.data + _segmentOffset, len, 0);
+
+    case AWS_SEGMENT_RAM_OWNED:
+    case AWS_SEGMENT_RAM_BORROWED:
+      return client->add((const char *) segment.data + _segmentOffset, len);
+
+    case AWS_SEGMENT_STRING:
+      return client->add(segment.string.c_str() + _segmentOffset, len);
+
+    case AWS_SEGMENT_CALLBACK:
+    {
+      if (!segment.filler)
+        return 0;
+
+      uint8_t *buf = (uint8_t *) malloc(len);
+
+      if (!buf)
+      {
+        AWS_LOGERROR1(F("[AsyncScatterGatherResponse::_sendSegment] malloc failed, size ="), len);
+
+        return RESPONSE_TRY_AGAIN;
+      }
+
+      size_t filled = segment.filler(buf, len, _segmentOffset);
+
+      if (filled != RESPONSE_TRY_AGAIN)
+        filled = filled ? client->add((const char *) buf, std::min(filled, len)) : 0;
+
+      free(buf);
+
+      return filled;
+    }
+
+    case AWS_SEGMENT_SPANS:
+    {
+      if (!_span.data)
+      {
+        if (!segment.spanFiller)
+          return 0;
+
+        AwsResponseSpan span = segment.spanFiller(len, _segmentOffset);
+
+        if (!span.data)
+          return (span.len == RESPONSE_TRY_AGAIN) ? RESPONSE_TRY_AGAIN : 0;
+
+        if (!span.len)
+          return 0;
+
+        _span = span;
+        _spanLength = std::min(span.len, segment.len - _segmentOffset);
+        _spanOffset = 0;
+      }
+
+      // Referenced by the TCP stack until acked, see _releaseSpans()
+      size_t added = client->add((const char *) _span.data + _spanOffset, std::min(len, _spanLength - _spanOffset), 0);
+
+      _spanOffset += added;
+
+      return added;
+    }
+
+    default:
+      return 0;
+  }
+}
+
+/////////////////////////////////////////////////
+
+size_t AsyncScatterGatherResponse::_ack(AsyncWebServerRequest *request, size_t len, uint32_t time)
+{
+  WT32_ETH01_AWS_UNUSED(time);
+
+  _ackedLength += len;
+
+  if (!_unacked.empty())
+    _releaseSpans(_ackedLength);
+
+  if (_state == RESPONSE_WAIT_ACK)
+  {
+    if (_ackedLength >= _writtenLength)
+      _state = RESPONSE_END;
+
+    return 0;
+  }
+
+  if (_state != RESPONSE_HEADERS && _state != RESPONSE_CONTENT)
+    return 0;
+
+  AsyncClient *client = request->client();
+
+  if (!client->canSend())
+    return 0;
+
+  size_t space = client->space();
+  size_t added = 0;
+
+  if (_state == RESPONSE_HEADERS)
+  {
+    size_t headAdded = client->add(_head.c_str() + _headOffset, std::min(space, _head.length() - _headOffset));
+
+    _headOffset += headAdded;
+    added += headAdded;
+    space -= headAdded;
+
+    if (_headOffset == _head.length())
+    {
+      _head = String();
+      _state = RESPONSE_CONTENT;
+    }
+  }
+
+  while (_state == RESPONSE_CONTENT)
+  {
+    if (_segmentIndex >= _segments.size())
+    {
+      _state = RESPONSE_WAIT_ACK;
+      break;
+    }
+
+    AwsResponseSegment& segment = _segments[_segmentIndex];
+
+    if (_segmentOffset >= segment.len)
+    {
+      _segmentIndex++;
+      _segmentOffset = 0;
+      continue;
+    }
+
+    if (!space)
+      break;
+
+    size_t segmentAdded = _sendSegment(client, segment, std::min(space, segment.len - _segmentOffset));
+
+    if (segmentAdded == RESPONSE_TRY_AGAIN)
+      break;
+
+    if (!segmentAdded)
+    {
+      // A callback ended before its declared length, or the TCP stack refused the data
+      AWS_LOGERROR1(F("[AsyncScatterGatherResponse::_ack] Failed sending segment"), _segmentIndex);
+
+      _state = RESPONSE_FAILED;
+
+      if (_unackedByReference())
+      {
+        client->abort();
+        _aborted = true;
+      }
+      else
+        client->close(true);
+
+      return 0;
+    }
+
+    _segmentOffset += segmentAdded;
+    _sentLength += segmentAdded;
+    added += segmentAdded;
+    space -= segmentAdded;
+
+    if (_span.data && _spanOffset == _spanLength)
+    {
+      _unacked.push_back({ _span, _writtenLength + added, _segmentIndex });
+      _span = { nullptr, 0 };
+    }
+  }
+
+  if (added)
+  {
+    _writtenLength += added;
+    client->send();
+  }
+
+  return added;
+}
+
+/////////////////////////////////////////////////
+/////////////////////////////////////////////////
+
+/*
+   Cached File Response
+ * */
+
+AsyncCachedFileResponse::AsyncCachedFileResponse(AsyncCachedFile* file)
+  : AsyncScatterGatherResponse(200), _file(file)
+{
+  _file->retain();
+
+  // Ranges are served from the FS, not from RAM
+  addHeader("Accept-Ranges", "bytes");
+  addBorrowed(_file->data, _file->size);
+}
+
+/////////////////////////////////////////////////
+
+AsyncCachedFileResponse::~AsyncCachedFileResponse()
+{
+  _file->release();
+}
+
+/////////////////////////////////////////////////
+
+String AsyncCachedFileResponse::_assembleHead(uint8_t version)
+{
+  String head = AsyncScatterGatherResponse::_assembleHead(version);
+
+  // Insert the precomputed lines before the empty line ending the head
+  String out;
+  out.reserve(head.length() + _file->headers.length());
+  out.concat(head.c_str(), head.length() - 2);
+  out.concat(_file->headers);
+  out.concat("\r\n");
+
+  _headLength = out.length();
+
+  return out;
+}
+
+/////////////////////////////////////////////////
+/////////////////////////////////////////////////
+
+/*
+   Rendered Response
+ * */
+
+AsyncRenderedResponse::AsyncRenderedResponse(AsyncRenderedEntry* entry)
+  : AsyncScatterGatherResponse(200), _entry(entry)
+{
+  _entry->retain();
+  addBorrowed((const uint8_t *) _entry->data.c_str(), _entry->data.length());
+}
+
+/////////////////////////////////////////////////
+
+AsyncRenderedResponse::~AsyncRenderedResponse()
+{
+  _entry->release();
+}
+
+/////////////////////////////////////////////////
+
+String AsyncRenderedResponse::_assembleHead(uint8_t version __attribute__((unused)))
+{
+  _headers.free();
+  _headLength = 0;
+
+  return String();
+}
+
 /////////////////////////////////////////////////
 
 }
\ No newline at end of file
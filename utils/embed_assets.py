@@ -0,0 +1,294 @@
+#!/usr/bin/env python3
+"""
+Embed a directory of static files into a C++ header for AsyncEmbeddedWebHandler (src/AsyncEmbeddedAssets.h).
+
+  python3 utils/embed_assets.py data embedded_assets.h [--name embeddedAssets] [--cache-control "max-age=86400"]
+  python3 utils/embed_assets.py --image data assets.bin       (image for a data partition, see src/AsyncAssetStore.h)
+
+For each file the header holds, in flash:
+  - the content, gzipped when it saves at least 10% (files already named *.gz are served as gzip, without .gz)
+  - the response headers : Cache-Control, Vary, ETag first (also sent with a 304), then Content-Length,
+    Content-Type, Content-Encoding, ... The status line is added when serving, for the request's HTTP version
+  - a perfect hash table of the URLs, for O(1) lookup
+index.htm / index.html are also served for their directory URL.
+Gzipped content is only sent to clients accepting gzip, others get 406 : there is no identity copy.
+A file and its precompressed *.gz (style.css and style.css.gz) would both be served as the same URL : that is an error.
+"""
+
+import argparse
+import gzip
+import hashlib
+import os
+import re
+import struct
+import sys
+
+# Same types as AsyncFileResponse::contentTypeFor()
+MIME_TYPES = {
+    ".html": "text/html", ".htm": "text/html", ".css": "text/css", ".json": "application/json",
+    ".js": "application/javascript", ".mjs": "application/javascript", ".png": "image/png",
+    ".gif": "image/gif", ".jpg": "image/jpeg", ".jpeg": "image/jpeg", ".ico": "image/x-icon",
+    ".svg": "image/svg+xml", ".webp": "image/webp", ".eot": "font/eot", ".woff": "font/woff",
+    ".woff2": "font/woff2", ".ttf": "font/ttf", ".xml": "text/xml", ".pdf": "application/pdf",
+    ".zip": "application/zip", ".gz": "application/x-gzip", ".wasm": "application/wasm",
+    ".txt": "text/plain",
+}
+
+# Already compressed formats, not worth gzipping
+NO_GZIP = {".png", ".gif", ".jpg", ".jpeg", ".webp", ".woff", ".woff2", ".zip", ".gz", ".pdf"}
+
+INDEX_FILES = ("index.htm", "index.html")
+
+# Must match src/AsyncAssetStore.h
+IMAGE_MAGIC = 0x41535741
+IMAGE_VERSION = 2
+
+
+def fnv_hash(seed, key):
+    # Must match embeddedAssetHash() in AsyncEmbeddedAssets.h
+    h = seed if seed else 0x01000193
+    for c in key.encode("utf-8"):
+        h = ((h * 0x01000193) ^ c) & 0xFFFFFFFF
+    return h
+
+
+def perfect_hash(keys):
+    """Hash and displace : returns (displacements, slots) so that every key gets its own slot."""
+    size = len(keys)
+
+    # Two equal keys always collide, whatever the seed : the search below would never end
+    if len(set(keys)) != size:
+        raise ValueError("duplicate keys")
+    buckets = [[] for _ in range(size)]
+
+    for index, key in enumerate(keys):
+        buckets[fnv_hash(0, key) % size].append(index)
+
+    displacements = [0] * size
+    slots = [None] * size
+
+    for bucket in sorted(buckets, key=len, reverse=True):
+        if len(bucket) <= 1:
+            break
+
+        seed = 1
+        taken = []
+        item = 0
+
+        while item < len(bucket):
+            slot = fnv_hash(seed, keys[bucket[item]]) % size
+
+            if slots[slot] is not None or slot in taken:
+                seed += 1
+                item = 0
+                taken = []
+            else:
+                taken.append(slot)
+                item += 1
+
+        displacements[fnv_hash(0, keys[bucket[0]]) % size] = seed
+
+        for index, slot in zip(bucket, taken):
+            slots[slot] = index
+
+    free = [slot for slot in range(size) if slots[slot] is None]
+
+    for bucket in buckets:
+        if len(bucket) == 1:
+            slot = free.pop()
+            displacements[fnv_hash(0, keys[bucket[0]]) % size] = -slot - 1
+            slots[slot] = bucket[0]
+
+    return displacements, slots
+
+
+def c_bytes(data, indent="  "):
+    lines = []
+
+    for i in range(0, len(data), 16):
+        lines.append(indent + ", ".join("0x%02X" % b for b in data[i:i + 16]) + ",")
+
+    return "\n".join(lines) if lines else indent + "0x00"
+
+
+def c_string(text):
+    return '"' + text.replace("\\", "\\\\").replace('"', '\\"').replace("\r", "\\r").replace("\n", "\\n") + '"'
+
+
+def load_assets(root, cache_control):
+    assets = []
+
+    for directory, _, files in sorted(os.walk(root)):
+        for filename in sorted(files):
+            path = os.path.join(directory, filename)
+            url = "/" + os.path.relpath(path, root).replace(os.sep, "/")
+            source = url
+
+            with open(path, "rb") as f:
+                content = f.read()
+
+            encoding = None
+
+            if url.endswith(".gz") and len(url) > 3 and os.path.splitext(url[:-3])[1]:
+                # Precompressed file : served for the URL without .gz
+                url = url[:-3]
+                encoding = "gzip"
+            elif os.path.splitext(url)[1].lower() not in NO_GZIP:
+                compressed = gzip.compress(content, 9, mtime=0)
+
+                if len(compressed) <= len(content) * 0.9:
+                    content = compressed
+                    encoding = "gzip"
+
+            extension = os.path.splitext(url)[1].lower()
+            mime = MIME_TYPES.get(extension, "text/plain")
+            etag = '"%s"' % hashlib.sha1(content).hexdigest()[:16]
+
+            # Headers a 304 must repeat first, so that it sends a prefix of the head
+            head = ""
+
+            if cache_control:
+                head += "Cache-Control: %s\r\n" % cache_control
+
+            if encoding:
+                head += "Vary: Accept-Encoding\r\n"
+
+            head += "ETag: %s\r\n" % etag
+            head += "Connection: close\r\n"
+            not_modified_length = len(head)
+
+            head += "Content-Length: %d\r\n" % len(content)
+            head += "Content-Type: %s\r\n" % mime
+
+            if encoding:
+                head += "Content-Encoding: %s\r\n" % encoding
+
+            head += "Accept-Ranges: none\r\n"
+
+            assets.append({"url": url, "source": source, "content": content, "head": head.encode("ascii"),
+                           "not_modified_length": not_modified_length, "gzip": encoding == "gzip", "etag": etag})
+
+    return assets
+
+
+def align4(data):
+    return data + b"\0" * (-len(data) % 4)
+
+
+def write_image(path, assets, entries, displacements, slots):
+    count = len(entries)
+    index_size = 16 + 4 * count + len(align4(b"\0\0" * count)) + 32 * count
+    blobs = bytearray()
+
+    def add_blob(data):
+        offset = index_size + len(blobs)
+        blobs.extend(align4(data))
+        return offset
+
+    heads = [add_blob(asset["head"]) for asset in assets]
+    contents = [add_blob(asset["content"]) for asset in assets]
+    etags = [add_blob(asset["etag"].encode("ascii") + b"\0") for asset in assets]
+    records = bytearray()
+
+    for url, i in entries:
+        records += struct.pack("<8I", add_blob(url.encode("utf-8") + b"\0"), heads[i], len(assets[i]["head"]),
+                               contents[i], len(assets[i]["content"]), etags[i], assets[i]["not_modified_length"],
+                               1 if assets[i]["gzip"] else 0)
+
+    image = struct.pack("<IHHII", IMAGE_MAGIC, IMAGE_VERSION, 0, count, index_size + len(blobs))
+    image += struct.pack("<%di" % count, *displacements)
+    image += align4(struct.pack("<%dH" % count, *slots))
+    image += records
+
+    assert len(image) == index_size
+
+    with open(path, "wb") as f:
+        f.write(image + blobs)
+
+    return len(image) + len(blobs)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Embed static files for AsyncEmbeddedWebHandler")
+    parser.add_argument("data", help="directory to embed")
+    parser.add_argument("output", help="header to write, or image with --image")
+    parser.add_argument("--image", action="store_true", help="write a binary image for AsyncAssetStore")
+    parser.add_argument("--name", default="embeddedAssets", help="name of the AwsEmbeddedBundle")
+    parser.add_argument("--cache-control", default="", help="Cache-Control value baked in every head")
+    args = parser.parse_args()
+
+    if not re.match(r"^[A-Za-z_]\w*$", args.name):
+        sys.exit("invalid --name")
+
+    assets = load_assets(args.data, args.cache_control)
+    sources = {}
+
+    for asset in assets:
+        if asset["url"] in sources:
+            sys.exit("%s and %s would both be served as %s, keep only one" % (
+                sources[asset["url"]], asset["source"], asset["url"]))
+
+        sources[asset["url"]] = asset["source"]
+
+    # Directory URLs : same asset under a second key
+    entries = [(asset["url"], i) for i, asset in enumerate(assets)]
+
+    for i, asset in enumerate(assets):
+        directory, filename = asset["url"].rsplit("/", 1)
+
+        if filename in INDEX_FILES and not any(url == directory + "/" for url, _ in entries):
+            entries.append((directory + "/", i))
+
+    urls = [url for url, _ in entries]
+    displacements, slots = perfect_hash(urls)
+
+    if not entries:
+        sys.exit("nothing to embed in %s" % args.data)
+
+    if args.image:
+        size = write_image(args.output, assets, entries, displacements, slots)
+        print("%d files, %d URLs, %d bytes image" % (len(assets), len(urls), size))
+        return
+
+    guard = re.sub(r"\W", "_", os.path.basename(args.output)).upper() + "_"
+
+    out = []
+    out.append("// Generated by utils/embed_assets.py from %s, do not edit" % args.data)
+    out.append("")
+    out.append("#ifndef %s" % guard)
+    out.append("#define %s" % guard)
+    out.append("")
+    out.append('#include "AsyncEmbeddedAssets.h"')
+    out.append("")
+
+    for i, asset in enumerate(assets):
+        out.append("// %s" % asset["url"])
+        out.append("static const uint8_t %s_head_%d[] PROGMEM =\n{\n%s\n};\n" % (args.name, i, c_bytes(asset["head"])))
+        out.append("static const uint8_t %s_content_%d[] PROGMEM =\n{\n%s\n};\n" % (args.name, i, c_bytes(asset["content"])))
+
+    out.append("static const eth::AwsEmbeddedAsset %s_assets[] =\n{" % args.name)
+
+    for url, i in entries:
+        asset = assets[i]
+        out.append("  { %s, %s_head_%d, %d, %d, %s_content_%d, %d, %s, %s }," % (
+            c_string(url), args.name, i, len(asset["head"]), asset["not_modified_length"], args.name, i,
+            len(asset["content"]), c_string(asset["etag"]), "true" if asset["gzip"] else "false"))
+
+    out.append("};\n")
+    out.append("static const int32_t %s_displacements[] =\n{\n  %s\n};\n" % (
+        args.name, ", ".join(str(d) for d in displacements)))
+    out.append("static const uint16_t %s_slots[] =\n{\n  %s\n};\n" % (
+        args.name, ", ".join(str(s) for s in slots)))
+    out.append("static const eth::AwsEmbeddedBundle %s =\n{\n  %s_assets, %s_displacements, %s_slots, %d\n};\n" % (
+        args.name, args.name, args.name, args.name, len(urls)))
+    out.append("#endif    // %s" % guard)
+
+    with open(args.output, "w", newline="\n") as f:
+        f.write("\n".join(out) + "\n")
+
+    total = sum(len(asset["content"]) + len(asset["head"]) for asset in assets)
+    print("%d files, %d URLs, %d bytes of flash" % (len(assets), len(urls), total))
+
+
+if __name__ == "__main__":
+    main()
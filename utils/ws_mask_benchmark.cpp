@@ -0,0 +1,117 @@
+/*
+  Host benchmark of the WebSocket masking kernel (src/AsyncWebSocketMask.h) against the former byte loop.
+
+  g++ -O2 -std=gnu++11 -I src -o ws_mask_benchmark utils/ws_mask_benchmark.cpp && ./ws_mask_benchmark
+
+  Checks first that both give the same bytes for every alignment, frame offset and short length,
+  then times the unmasking of 64 KB binary frames.
+*/
+
+#include "AsyncWebSocketMask.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+
+using namespace eth;
+
+#define FRAME_SIZE      65536
+#define ITERATIONS      2000
+
+/////////////////////////////////////////////////
+
+// As in AsyncWebSocketClient::_onData() before
+static void maskBytes(uint8_t* data, size_t len, const uint8_t mask[4], uint64_t index)
+{
+  for (size_t i = 0; i < len; i++)
+    data[i] ^= mask[(index + i) % 4];
+}
+
+/////////////////////////////////////////////////
+
+static bool check()
+{
+  static uint8_t expected[FRAME_SIZE + 8];
+  static uint8_t actual[FRAME_SIZE + 8];
+  const uint8_t mask[4] = { 0x37, 0xFA, 0x21, 0x3D };
+
+  for (size_t offset = 0; offset < 8; offset++)
+  {
+    for (uint64_t index = 0; index < 8; index++)
+    {
+      for (size_t len = 0; len <= 80; len++)
+      {
+        for (size_t i = 0; i < len + 8; i++)
+          expected[i] = actual[i] = (uint8_t) rand();
+
+        maskBytes(expected + offset, len, mask, index);
+        webSocketMask(actual + offset, len, mask, index);
+
+        if (memcmp(expected, actual, len + 8))
+        {
+          printf("Mismatch : offset %zu, index %llu, length %zu\n", offset, (unsigned long long) index, len);
+
+          return false;
+        }
+      }
+    }
+
+    for (size_t i = 0; i < FRAME_SIZE; i++)
+      expected[offset + i] = actual[offset + i] = (uint8_t) rand();
+
+    maskBytes(expected + offset, FRAME_SIZE, mask, offset);
+    webSocketMask(actual + offset, FRAME_SIZE, mask, offset);
+
+    if (memcmp(expected, actual, FRAME_SIZE + 8))
+    {
+      printf("Mismatch : 64 KB frame, offset %zu\n", offset);
+
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/////////////////////////////////////////////////
+
+template<typename Kernel>
+static double megabytesPerSecond(Kernel kernel, uint8_t* frame)
+{
+  const uint8_t mask[4] = { 0x12, 0x34, 0x56, 0x78 };
+  auto start = std::chrono::steady_clock::now();
+
+  for (int i = 0; i < ITERATIONS; i++)
+  {
+    kernel(frame, FRAME_SIZE, mask, 0);
+    // Keep the compiler from merging iterations
+    __asm__ __volatile__("" : : "r"(frame) : "memory");
+  }
+
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  return (double) FRAME_SIZE * ITERATIONS / elapsed.count() / 1e6;
+}
+
+/////////////////////////////////////////////////
+
+int main()
+{
+  if (!check())
+    return 1;
+
+  printf("Same output as the byte loop : OK\n");
+
+  static uint8_t frame[FRAME_SIZE];
+
+  for (size_t i = 0; i < FRAME_SIZE; i++)
+    frame[i] = (uint8_t) i;
+
+  double bytes = megabytesPerSecond(maskBytes, frame);
+  double words = megabytesPerSecond(webSocketMask, frame);
+
+  printf("64 KB frames, byte loop     : %8.1f MB/s\n", bytes);
+  printf("64 KB frames, webSocketMask : %8.1f MB/s (x%.1f)\n", words, words / bytes);
+
+  return 0;
+}